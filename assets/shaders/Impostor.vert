@@ -0,0 +1,74 @@
+#version 430 core
+layout(location = 0) in vec3 aPos;
+
+// Visible instance slot (compacted by FrustumCull, offset per mesh through baseInstance)
+layout(location = 3) in uint aInstanceSlot;
+
+struct Camera {
+    mat4 view;
+    mat4 projection;
+    mat4 viewInverse;
+    mat4 projInverse;
+};
+
+struct Transform {
+    vec3 position;
+    vec4 rotation;
+    vec3 scale;
+};
+
+struct MeshDraw {
+    uint indexCount;
+    uint firstIndex;
+    int baseVertex;
+    uint instanceStart;
+    float boundingRadius;
+    uint commandIndex;
+};
+
+layout(std140, binding = 0) uniform CameraData {
+    Camera camera;
+};
+
+layout(std430, binding = 5) buffer InstanceTransformData {
+    Transform instanceTransforms[];
+};
+
+layout(std430, binding = 8) buffer InstanceToEntityIndexData {
+    uint instanceToEntityIndex[];
+};
+
+layout(std430, binding = 30) buffer MeshDrawData {
+    MeshDraw meshDraws[];
+};
+
+out vec3 v_ViewPosition;
+flat out vec3 v_ViewCenter;
+flat out float v_Radius;
+flat out uint v_GlobalInstanceIndex;
+
+void main() {
+    uint index = aInstanceSlot;
+
+    Transform instanceTransform = instanceTransforms[index];
+    vec3 scale = abs(instanceTransform.scale);
+    float radius = meshDraws[instanceToEntityIndex[index]].boundingRadius * max(scale.x, max(scale.y, scale.z));
+
+    // 1. Billboard Basis (faces the eye, not the view plane, so off-axis spheres stay covered)
+    vec3 center = (camera.view * vec4(instanceTransform.position, 1.0)).xyz;
+    float distance = length(center);
+    vec3 forward = center / distance;
+    vec3 right = normalize(cross(forward, vec3(0.0, 1.0, 0.0)));
+    vec3 up = cross(right, forward);
+
+    // 2. Silhouette Size (the tangent cone cuts the billboard plane wider than the radius)
+    float size = radius * distance / sqrt(max(distance * distance - radius * radius, 1e-6));
+    vec3 corner = center + (right * aPos.x + up * aPos.y) * size;
+
+    gl_Position = camera.projection * vec4(corner, 1.0);
+
+    v_ViewPosition = corner;
+    v_ViewCenter = center;
+    v_Radius = radius;
+    v_GlobalInstanceIndex = index;
+}
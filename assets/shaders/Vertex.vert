@@ -3,6 +3,9 @@ layout(location = 0) in vec3 aPos;
 layout(location = 1) in vec3 aNormal;
 layout(location = 2) in vec2 aTexC;
 
+// Visible instance slot (compacted by FrustumCull, offset per mesh through baseInstance)
+layout(location = 3) in uint aInstanceSlot;
+
 struct Camera {
     mat4 view;
     mat4 projection;
@@ -24,8 +27,6 @@ layout(std430, binding = 5) buffer InstanceTransformData {
     Transform instanceTransforms[];
 };
 
-uniform uint instanceStartIndex;
-
 out VS_OUT {
     vec3 normal;
     uint instanceIndex;
@@ -71,7 +72,7 @@ mat4 BuildModelMatrix(vec3 position, vec4 rotation, vec3 scale) {
 }
 
 void main() {
-    uint index = gl_InstanceID + instanceStartIndex;
+    uint index = aInstanceSlot;
 
     Transform instanceTransform = instanceTransforms[index];
 
@@ -0,0 +1,56 @@
+#version 430 core
+
+struct Camera {
+    mat4 view;
+    mat4 projection;
+    mat4 viewInverse;
+    mat4 projInverse;
+};
+
+struct Material {
+    vec4 color;
+    float emission;
+    float roughness;
+    float metallic;
+};
+
+layout(std140, binding = 0) uniform CameraData {
+    Camera camera;
+};
+
+layout (std430, binding = 7) buffer InstanceMaterialData {
+    Material instanceMaterials[];
+};
+
+in vec3 v_ViewPosition;
+flat in vec3 v_ViewCenter;
+flat in float v_Radius;
+flat in uint v_GlobalInstanceIndex;
+
+out vec4 FragColor;
+
+void main() {
+    // 1. Ray-Sphere (eye at the view space origin, nearest hit)
+    vec3 rayDirection = normalize(v_ViewPosition);
+    float b = dot(rayDirection, v_ViewCenter);
+    float h = b * b - dot(v_ViewCenter, v_ViewCenter) + v_Radius * v_Radius;
+    if (h < 0.0) discard;
+
+    vec3 hit = rayDirection * (b - sqrt(h));
+
+    // 2. Depth of the hit, not of the quad
+    vec4 clip = camera.projection * vec4(hit, 1.0);
+    gl_FragDepth = 0.5 * (clip.z / clip.w) * (gl_DepthRange.far - gl_DepthRange.near) + 0.5 * (gl_DepthRange.far + gl_DepthRange.near);
+
+    // 3. Shade like Color.frag (world space normal)
+    vec3 normal = transpose(mat3(camera.view)) * ((hit - v_ViewCenter) / v_Radius);
+    Material instanceMaterial = instanceMaterials[v_GlobalInstanceIndex];
+
+    if(instanceMaterial.emission > 0.0) {
+        FragColor = instanceMaterial.color * instanceMaterial.emission;
+    } else {
+        vec3 lightDir = normalize(vec3(1, 1, 1));
+        float diff = max(dot(normalize(normal), lightDir), 0.1);
+        FragColor = instanceMaterial.color * vec4(vec3(diff), 1.0);
+    }
+}
@@ -0,0 +1,90 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+#include <Spade/Spade.hpp>
+
+using namespace Spade;
+
+struct Position { float x, y, z; };
+struct Velocity { float x, y, z; };
+struct Mass { float value; };
+struct Tag { int value; };
+
+Universe universe;
+
+// One integration pass (position += velocity * dt / mass) over entities holding Position, Velocity and Mass,
+// through a cached pool view and through the archetype chunks. A quarter of the entities also carry a Tag,
+// so the archetype side walks two archetypes.
+int main() {
+
+  const size_t entityCount = 1000000;
+  const int passes = 20;
+  const float deltaTime = 0.016f;
+
+  std::vector<EntityID> entities = universe.CreateEntityIDs(entityCount);
+  ArchetypeStorage& archetypes = universe.GetArchetypes();
+
+  for (size_t i = 0; i < entityCount; ++i) {
+    const EntityID entity = entities[i];
+    const Position position = { (float)i, 0.0f, 0.0f };
+    const Velocity velocity = { 1.0f, 2.0f, 3.0f };
+    const Mass mass = { 1.0f + (float)(i % 7) };
+
+    universe.GetPool<Position>().Add(entity, position);
+    universe.GetPool<Velocity>().Add(entity, velocity);
+    universe.GetPool<Mass>().Add(entity, mass);
+    archetypes.Add(entity, position);
+    archetypes.Add(entity, velocity);
+    archetypes.Add(entity, mass);
+
+    if (i % 4 == 0) {
+      universe.GetPool<Tag>().Add(entity, { 1 });
+      archetypes.Add(entity, Tag{ 1 });
+    }
+  }
+
+  auto time = [&](auto&& pass) {
+    pass();
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < passes; ++i) pass();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / passes;
+  };
+
+  const double viewTime = time([&]() {
+    universe.View<Position, Velocity, Mass>().Each([&](EntityID, Position& position, Velocity& velocity, Mass& mass) {
+      const float scale = deltaTime / mass.value;
+      position.x += velocity.x * scale;
+      position.y += velocity.y * scale;
+      position.z += velocity.z * scale;
+    });
+  });
+
+  const double chunkTime = time([&]() {
+    archetypes.EachChunk<Position, Velocity, Mass>([&](size_t count, const EntityID*, Position* positions, Velocity* velocities, Mass* masses) {
+      for (size_t i = 0; i < count; ++i) {
+        const float scale = deltaTime / masses[i].value;
+        positions[i].x += velocities[i].x * scale;
+        positions[i].y += velocities[i].y * scale;
+        positions[i].z += velocities[i].z * scale;
+      }
+    });
+  });
+
+  // Both sides ran the same passes, so they must agree
+  float maxError = 0.0f;
+  archetypes.Each<Position>([&](EntityID entity, Position& position) {
+    maxError = std::max(maxError, std::abs(position.x - universe.GetPool<Position>().Get(entity)->x));
+  });
+
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << entityCount << " entities, " << archetypes.GetArchetypeCount() << " archetypes, max difference " << maxError << std::endl;
+  std::cout << std::setw(20) << "Pool view" << std::setw(12) << viewTime << " ms / pass" << std::endl;
+  std::cout << std::setw(20) << "Archetype chunks" << std::setw(12) << chunkTime << " ms / pass" << std::endl;
+
+  return 0;
+}
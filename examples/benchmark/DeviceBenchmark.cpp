@@ -0,0 +1,100 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <thread>
+
+#include <Spade/Spade.hpp>
+
+using namespace Spade;
+
+Engine engine;
+Universe universe;
+
+// Steps per second of the same fluid + collision step on the GPU and on the CPU backend (AVX2, scalar, one thread).
+// Particle counts run largest first so every later upload fits in the buffers allocated by the first.
+int main() {
+
+  const std::vector<int> particleCounts = { 262144, 65536, 16384, 4096 };
+  const int iterations = 20;
+  const float bounds = 10.0f;
+  const float cellSize = 0.4f;
+  const float deltaTime = 0.005f;
+
+  EntityID particlesID = universe.CreateEntityID();
+  Entity particles = Entity(particlesID, &universe);
+
+  particles.AddComponent<TransformComponent>();
+  particles.AddComponent<BoundingComponent>()->bound.size = 0.2f;
+  particles.AddComponent<FluidComponent>();
+  particles.AddComponent<MeshComponent>();
+  particles.GetComponent<MeshComponent>()->mesh = GenerateSphere(0.1, 4, 4);
+
+  engine.SetupEngineWindow(320, 240, "Spade Device Benchmark");
+
+  auto spawnParticles = [&](int count) {
+    MeshComponent* meshComponent = particles.GetComponent<MeshComponent>();
+    meshComponent->instanceTransforms.clear();
+    meshComponent->instanceMotions.clear();
+    meshComponent->instanceMaterials.clear();
+    meshComponent->SpawnInstancesInCube(bounds, {0.0, 0.0, 0.0}, count);
+    meshComponent->SetMass(0.01f);
+
+    // Reload on the GPU so the buffers hold the fresh spawn whichever device runs next
+    engine.SetSimulationDevice(GPUDevice);
+    engine.LoadInstanceBuffers(universe);
+    engine.LoadCollisionBuffers(universe);
+    engine.LoadFluidBuffers(universe);
+    engine.LoadGridBuffers();
+  };
+
+  auto step = [&]() {
+    engine.EnableGravity(-9.8f);
+    engine.EnableSPHFluid(bounds, cellSize);
+    engine.EnableGridCollision(bounds, cellSize);
+    engine.EnableMotion(deltaTime);
+  };
+
+  auto stepsPerSecond = [&](SimulationDevice device) {
+    engine.SetSimulationDevice(device);
+
+    step();
+    glFinish();
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      step();
+    }
+    glFinish();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    return iterations / elapsed.count();
+  };
+
+  std::cout << "CPU threads: " << std::thread::hardware_concurrency() << std::endl;
+  std::cout << std::setw(10) << "N" << std::setw(12) << "GPU" << std::setw(12) << "CPU AVX2"
+            << std::setw(12) << "CPU Scalar" << std::setw(12) << "CPU 1 Core" << "   (steps / s)" << std::endl;
+
+  for (int count : particleCounts) {
+    std::cout << std::setw(10) << count << std::fixed << std::setprecision(1);
+
+    spawnParticles(count);
+    std::cout << std::setw(12) << stepsPerSecond(GPUDevice);
+
+    engine.SetCPUThreadCount(std::thread::hardware_concurrency());
+    engine.SetCPUUseAVX2(true);
+    spawnParticles(count);
+    std::cout << std::setw(12) << stepsPerSecond(CPUDevice);
+
+    engine.SetCPUUseAVX2(false);
+    spawnParticles(count);
+    std::cout << std::setw(12) << stepsPerSecond(CPUDevice);
+
+    engine.SetCPUThreadCount(1);
+    engine.SetCPUUseAVX2(true);
+    spawnParticles(count);
+    std::cout << std::setw(12) << stepsPerSecond(CPUDevice) << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,119 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+#include <Spade/Spade.hpp>
+
+using namespace Spade;
+
+Engine engine;
+Universe universe;
+
+// SPH density + force time of the separate shaders against the fused, tiled ones, for both grid modes, and the
+// largest acceleration difference between the two. The grid is built once per run and reused by every call.
+// Particle counts run largest first so every later upload fits in the buffers allocated by the first.
+int main() {
+
+  const std::vector<int> particleCounts = { 262144, 65536, 16384, 4096 };
+  const int iterations = 20;
+  const float bounds = 10.0f;
+  const float cellSize = 0.4f;
+
+  EntityID particlesID = universe.CreateEntityID();
+  Entity particles = Entity(particlesID, &universe);
+
+  particles.AddComponent<TransformComponent>();
+  particles.AddComponent<BoundingComponent>()->bound.size = 0.2f;
+  particles.AddComponent<FluidComponent>();
+  particles.AddComponent<MeshComponent>();
+  particles.GetComponent<MeshComponent>()->mesh = GenerateSphere(0.1, 4, 4);
+
+  engine.SetupEngineWindow(320, 240, "Spade Fluid Benchmark");
+
+  auto spawnParticles = [&](int count) {
+    MeshComponent* meshComponent = particles.GetComponent<MeshComponent>();
+    meshComponent->instanceTransforms.clear();
+    meshComponent->instanceMotions.clear();
+    meshComponent->instanceMaterials.clear();
+    meshComponent->SpawnInstancesInCube(bounds, {0.0, 0.0, 0.0}, count);
+    meshComponent->SetMass(0.01f);
+  };
+
+  auto loadParticles = [&]() {
+    engine.LoadInstanceBuffers(universe);
+    engine.LoadCollisionBuffers(universe);
+    engine.LoadFluidBuffers(universe);
+    engine.LoadGridBuffers();
+  };
+
+  // Accelerations after one SPH call on the freshly loaded particles
+  auto accelerations = [&](FluidKernel fluidKernel, size_t count) {
+    engine.SetFluidKernel(fluidKernel);
+    loadParticles();
+    engine.EnableSPHFluid(bounds, cellSize);
+
+    std::vector<ReadbackRecord> records;
+    const unsigned int readback = engine.RequestReadback(0, count);
+    glFinish();
+    while (!engine.TryGetReadback(readback, records)) {}
+
+    std::vector<glm::vec3> result(records.size());
+    std::transform(records.begin(), records.end(), result.begin(), [](const ReadbackRecord& record) { return record.motion.acceleration; });
+    return result;
+  };
+
+  auto milliseconds = [&](FluidKernel fluidKernel) {
+    engine.SetFluidKernel(fluidKernel);
+    engine.EnableSPHFluid(bounds, cellSize);
+    glFinish();
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      engine.EnableSPHFluid(bounds, cellSize);
+    }
+    glFinish();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    return elapsed.count() / iterations;
+  };
+
+  std::cout << std::setw(10) << "N" << std::setw(10) << "Grid" << std::setw(14) << "Separate ms"
+            << std::setw(12) << "Fused ms" << std::setw(10) << "Speedup" << std::setw(16) << "Max Rel Diff" << std::endl;
+
+  for (int count : particleCounts) {
+    spawnParticles(count);
+
+    for (GridMode gridMode : { HashedGrid, DenseGrid }) {
+      engine.SetGridMode(gridMode);
+
+      // 1. Accuracy (same particles, one call each)
+      const std::vector<glm::vec3> separate = accelerations(SeparateFluidKernel, count);
+      const std::vector<glm::vec3> fused = accelerations(FusedFluidKernel, count);
+
+      float maxDifference = 0.0f;
+      float maxAcceleration = 0.0f;
+      for (size_t i = 0; i < separate.size(); ++i) {
+        maxDifference = std::max(maxDifference, glm::length(separate[i] - fused[i]));
+        maxAcceleration = std::max(maxAcceleration, glm::length(separate[i]));
+      }
+
+      // 2. Time (the grid stays valid between SPH calls, so only the two SPH passes are measured)
+      loadParticles();
+      const double separateTime = milliseconds(SeparateFluidKernel);
+      const double fusedTime = milliseconds(FusedFluidKernel);
+
+      std::cout << std::setw(10) << count
+                << std::setw(10) << (gridMode == DenseGrid ? "Dense" : "Hashed")
+                << std::fixed << std::setprecision(3)
+                << std::setw(14) << separateTime
+                << std::setw(12) << fusedTime
+                << std::setprecision(2) << std::setw(9) << separateTime / fusedTime << "x"
+                << std::scientific << std::setw(16) << (maxAcceleration > 0.0f ? maxDifference / maxAcceleration : 0.0f)
+                << std::defaultfloat << std::endl;
+    }
+  }
+
+  return 0;
+}
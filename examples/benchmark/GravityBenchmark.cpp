@@ -0,0 +1,97 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <cmath>
+
+#include <Spade/Spade.hpp>
+
+using namespace Spade;
+
+Engine engine;
+Universe universe;
+
+// Barnes-Hut accuracy against theta = 0 (every leaf visited, the exact sum) and time against body count.
+// Body counts run largest first so every later upload fits in the buffers allocated by the first.
+int main() {
+
+  const std::vector<int> bodyCounts = { 262144, 65536, 16384, 4096 };
+  const std::vector<float> thetas = { 0.0f, 0.3f, 0.5f, 0.7f, 1.0f };
+  const int accuracyCount = 16384;
+  const int iterations = 10;
+  const float bounds = 10.0f;
+  const float gravityConstant = 1.0f;
+  const float softening = 0.05f;
+
+  EntityID bodiesID = universe.CreateEntityID();
+  Entity bodies = Entity(bodiesID, &universe);
+
+  bodies.AddComponent<TransformComponent>();
+  bodies.AddComponent<MeshComponent>();
+  bodies.GetComponent<MeshComponent>()->mesh = GenerateSphere(0.1, 4, 4);
+
+  engine.SetupEngineWindow(320, 240, "Spade Gravity Benchmark");
+
+  auto spawnBodies = [&](int count) {
+    MeshComponent* meshComponent = bodies.GetComponent<MeshComponent>();
+    meshComponent->instanceTransforms.clear();
+    meshComponent->instanceMotions.clear();
+    meshComponent->instanceMaterials.clear();
+    meshComponent->SpawnInstancesInCube(bounds, {0.0, 0.0, 0.0}, count);
+    meshComponent->SetMass(1.0f / count);
+    engine.LoadInstanceBuffers(universe);
+  };
+
+  // Average GPU time of one full step (tree build + force walk)
+  auto timeGravity = [&](float theta) {
+    engine.EnableBarnesHutGravity(gravityConstant, bounds, theta, softening);
+    glFinish();
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      engine.EnableBarnesHutGravity(gravityConstant, bounds, theta, softening);
+    }
+    glFinish();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    return elapsed.count() / iterations;
+  };
+
+  // Time vs N
+  std::cout << std::setw(10) << "N" << std::setw(10) << "Theta" << std::setw(14) << "ms / step" << std::endl;
+
+  for (int count : bodyCounts) {
+    spawnBodies(count);
+
+    std::cout << std::setw(10) << count
+              << std::setw(10) << std::fixed << std::setprecision(2) << 0.5f
+              << std::setw(14) << std::setprecision(3) << timeGravity(0.5f) << std::endl;
+  }
+
+  // Accuracy vs Theta (accelerations start at zero after every load)
+  std::cout << std::endl << std::setw(10) << "N" << std::setw(10) << "Theta" << std::setw(14) << "RMS error" << std::setw(14) << "ms / step" << std::endl;
+
+  std::vector<Motion> reference;
+
+  for (float theta : thetas) {
+    spawnBodies(accuracyCount);
+    engine.EnableBarnesHutGravity(gravityConstant, bounds, theta, softening);
+    std::vector<Motion> motions = engine.GetInstanceMotions();
+    if (reference.empty()) reference = motions;
+
+    double errorSq = 0.0;
+    double referenceSq = 0.0;
+    for (size_t i = 0; i < motions.size(); ++i) {
+      glm::vec3 error = motions[i].acceleration - reference[i].acceleration;
+      errorSq += glm::dot(error, error);
+      referenceSq += glm::dot(reference[i].acceleration, reference[i].acceleration);
+    }
+
+    std::cout << std::setw(10) << accuracyCount
+              << std::setw(10) << std::setprecision(2) << theta
+              << std::setw(14) << std::scientific << std::setprecision(3) << std::sqrt(errorSq / referenceSq)
+              << std::setw(14) << std::fixed << timeGravity(theta) << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,107 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <random>
+
+#include <Spade/Spade.hpp>
+
+using namespace Spade;
+
+// The flat lookup ComponentPool used before paging: one size_t per EntityID up to the largest one added,
+// 10,000 entries up front and +1000 past the entity on growth.
+struct FlatSparseSet {
+  static constexpr size_t INVALID_INDEX = 0xFFFFFFFF;
+
+  std::vector<size_t> entityToIndex = std::vector<size_t>(10000, INVALID_INDEX);
+  std::vector<EntityID> indexToEntity;
+
+  void Add(EntityID entity) {
+    if (entity >= entityToIndex.size()) {
+      entityToIndex.resize(entity + 1000, INVALID_INDEX);
+    }
+    entityToIndex[entity] = indexToEntity.size();
+    indexToEntity.push_back(entity);
+  }
+
+  bool Has(EntityID entity) const {
+    if (entity >= entityToIndex.size()) return false;
+    return entityToIndex[entity] != INVALID_INDEX;
+  }
+
+  size_t GetSparseMemory() const { return entityToIndex.capacity() * sizeof(size_t); }
+};
+
+struct Tag { unsigned int value = 0; };
+
+// Sparse lookup memory and random Has() time for 1M entities spread over many pools,
+// from every entity holding the component down to a single one (a camera at the last EntityID).
+int main() {
+
+  const EntityID entityCount = 1000000;
+  const std::vector<EntityID> strides = { 1, 4, 64, 1024, entityCount };
+  const int poolsPerStride = 8;
+  const int lookups = 4000000;
+
+  std::mt19937 random(1234);
+  std::uniform_int_distribution<EntityID> anyEntity(0, entityCount - 1);
+  std::vector<EntityID> queries(lookups);
+  for (EntityID& query : queries) query = anyEntity(random);
+
+  std::cout << std::setw(10) << "Stride" << std::setw(12) << "Members"
+            << std::setw(14) << "Flat MB" << std::setw(14) << "Paged MB"
+            << std::setw(14) << "Flat ns" << std::setw(14) << "Paged ns" << std::endl;
+
+  double flatTotal = 0.0;
+  double pagedTotal = 0.0;
+
+  for (EntityID stride : strides) {
+    std::vector<FlatSparseSet> flatPools(poolsPerStride);
+    std::vector<ComponentPool<Tag>> pagedPools(poolsPerStride);
+
+    // Members are the entities at a multiple of the stride, counted back from the last one
+    for (int p = 0; p < poolsPerStride; ++p) {
+      for (long long entity = entityCount - 1; entity >= 0; entity -= stride) {
+        flatPools[p].Add((EntityID)entity);
+        pagedPools[p].Add((EntityID)entity, Tag{ (unsigned int)entity });
+      }
+    }
+    const size_t members = pagedPools[0].m_Data.size();
+
+    size_t flatMemory = 0;
+    size_t pagedMemory = 0;
+    for (int p = 0; p < poolsPerStride; ++p) {
+      flatMemory += flatPools[p].GetSparseMemory();
+      pagedMemory += pagedPools[p].GetSparseMemory();
+    }
+
+    auto time = [&](auto& pools) {
+      size_t hits = 0;
+      auto start = std::chrono::high_resolution_clock::now();
+      for (int i = 0; i < lookups; ++i) {
+        hits += pools[i % poolsPerStride].Has(queries[i]);
+      }
+      auto end = std::chrono::high_resolution_clock::now();
+
+      // Keep the loop alive
+      if (hits == (size_t)-1) std::cout << hits;
+      return std::chrono::duration<double, std::nano>(end - start).count() / lookups;
+    };
+
+    const double flatTime = time(flatPools);
+    const double pagedTime = time(pagedPools);
+
+    flatTotal += flatMemory;
+    pagedTotal += pagedMemory;
+
+    std::cout << std::setw(10) << stride << std::setw(12) << members
+              << std::setw(14) << std::fixed << std::setprecision(2) << flatMemory / (1024.0 * 1024.0)
+              << std::setw(14) << pagedMemory / (1024.0 * 1024.0)
+              << std::setw(14) << flatTime << std::setw(14) << pagedTime << std::endl;
+  }
+
+  std::cout << "Sparse memory of all " << strides.size() * poolsPerStride << " pools: "
+            << flatTotal / (1024.0 * 1024.0) << " MB flat, " << pagedTotal / (1024.0 * 1024.0) << " MB paged" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,103 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <typeinfo>
+#include <unordered_map>
+
+#include <Spade/Spade.hpp>
+
+using namespace Spade;
+
+// The pool lookup Universe used before the dense registry: typeid hash into an unordered_map on every call.
+struct HashedUniverse {
+  std::unordered_map<size_t, std::unique_ptr<IComponentPool>> pools;
+
+  template<typename T>
+  ComponentPool<T>& GetPool() {
+    static size_t typeID = typeid(T).hash_code();
+    if (pools.find(typeID) == pools.end()) {
+      pools[typeID] = std::make_unique<ComponentPool<T>>();
+    }
+    return static_cast<ComponentPool<T>&>(*pools[typeID]);
+  }
+};
+
+template<int N>
+struct Tag { float value = 0.0f; };
+
+// GetPool<T>().Get(entity) per component access for eight types, through the old hashed map,
+// the dense registry, and a pool reference cached outside the loop.
+int main() {
+
+  const EntityID entityCount = 100000;
+  const int passes = 20;
+
+  HashedUniverse hashed;
+  Universe dense;
+
+  auto fill = [&](auto& universe) {
+    for (EntityID e = 0; e < entityCount; ++e) {
+      universe.template GetPool<Tag<0>>().Add(e, {});
+      universe.template GetPool<Tag<1>>().Add(e, {});
+      universe.template GetPool<Tag<2>>().Add(e, {});
+      universe.template GetPool<Tag<3>>().Add(e, {});
+      universe.template GetPool<Tag<4>>().Add(e, {});
+      universe.template GetPool<Tag<5>>().Add(e, {});
+      universe.template GetPool<Tag<6>>().Add(e, {});
+      universe.template GetPool<Tag<7>>().Add(e, {});
+    }
+  };
+  fill(hashed);
+  fill(dense);
+
+  // Eight accesses per entity, each going through GetPool
+  auto perAccess = [&](auto& universe) {
+    float sum = 0.0f;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+      for (EntityID e = 0; e < entityCount; ++e) {
+        sum += universe.template GetPool<Tag<0>>().Get(e)->value;
+        sum += universe.template GetPool<Tag<1>>().Get(e)->value;
+        sum += universe.template GetPool<Tag<2>>().Get(e)->value;
+        sum += universe.template GetPool<Tag<3>>().Get(e)->value;
+        sum += universe.template GetPool<Tag<4>>().Get(e)->value;
+        sum += universe.template GetPool<Tag<5>>().Get(e)->value;
+        sum += universe.template GetPool<Tag<6>>().Get(e)->value;
+        sum += universe.template GetPool<Tag<7>>().Get(e)->value;
+      }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    // Keep the loop alive
+    if (sum != 0.0f) std::cout << sum;
+    return std::chrono::duration<double, std::nano>(end - start).count() / ((double)passes * entityCount * 8);
+  };
+
+  // Same accesses through pool references fetched once
+  auto cached = [&]() {
+    auto [p0, p1, p2, p3] = dense.GetPools<Tag<0>, Tag<1>, Tag<2>, Tag<3>>();
+    auto [p4, p5, p6, p7] = dense.GetPools<Tag<4>, Tag<5>, Tag<6>, Tag<7>>();
+
+    float sum = 0.0f;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+      for (EntityID e = 0; e < entityCount; ++e) {
+        sum += p0.Get(e)->value + p1.Get(e)->value + p2.Get(e)->value + p3.Get(e)->value;
+        sum += p4.Get(e)->value + p5.Get(e)->value + p6.Get(e)->value + p7.Get(e)->value;
+      }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    if (sum != 0.0f) std::cout << sum;
+    return std::chrono::duration<double, std::nano>(end - start).count() / ((double)passes * entityCount * 8);
+  };
+
+  std::cout << std::setw(24) << "Lookup" << std::setw(16) << "ns / access" << std::endl;
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << std::setw(24) << "Hashed GetPool + Get" << std::setw(16) << perAccess(hashed) << std::endl;
+  std::cout << std::setw(24) << "Dense GetPool + Get" << std::setw(16) << perAccess(dense) << std::endl;
+  std::cout << std::setw(24) << "Cached pool + Get" << std::setw(16) << cached() << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,57 @@
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+#include <Spade/Spade.hpp>
+
+using namespace Spade;
+
+struct ContextData { };
+struct PoolData { };
+
+// A context system and a later pool system with disjoint access must overlap: the context system waits (with a
+// timeout) for the pool system to start. Run time is about one system's work when they overlap, two when serialized.
+int main() {
+
+  const int iterations = 20;
+  const auto work = std::chrono::milliseconds(20);
+  const auto timeout = std::chrono::milliseconds(500);
+
+  Scheduler scheduler(std::max(2u, std::thread::hardware_concurrency()));
+  std::atomic<bool> poolStarted = false;
+  std::atomic<int> overlapped = 0;
+
+  scheduler.AddSystem("Context", [&]() {
+    auto start = std::chrono::steady_clock::now();
+    while (!poolStarted.load() && std::chrono::steady_clock::now() - start < timeout) {
+      std::this_thread::yield();
+    }
+    if (poolStarted.load()) overlapped++;
+    std::this_thread::sleep_for(work);
+  }).Writes<ContextData>().OnContextThread();
+
+  scheduler.AddSystem("Pool", [&]() {
+    poolStarted.store(true);
+    std::this_thread::sleep_for(work);
+  }).Writes<PoolData>();
+
+  double totalTime = 0.0;
+  for (int i = 0; i < iterations; ++i) {
+    poolStarted.store(false);
+
+    auto start = std::chrono::steady_clock::now();
+    scheduler.Run();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    totalTime += elapsed.count();
+  }
+
+  std::cout << "Critical path: " << scheduler.GetCriticalPathLength() << " (1 expected)" << std::endl;
+  std::cout << "Overlapped runs: " << overlapped.load() << " / " << iterations << std::endl;
+  std::cout << "Run ms: " << std::fixed << std::setprecision(2) << totalTime / iterations
+            << " (work " << work.count() << " ms per system)" << std::endl;
+
+  return (overlapped.load() == iterations && scheduler.GetCriticalPathLength() == 1) ? 0 : 1;
+}
@@ -0,0 +1,73 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+#include <Spade/Spade.hpp>
+
+using namespace Spade;
+
+Engine engine;
+Universe universe;
+
+// Measures the grid sort inside BuildGrid for both hashed-grid algorithms and the dense counting sort.
+// Particle counts run largest first so every later upload fits in the buffers allocated by the first.
+int main() {
+
+  const std::vector<int> particleCounts = { 1048576, 262144, 65536, 16384, 4096 };
+  const int iterations = 20;
+  const float bounds = 10.0f;
+  const float cellSize = 0.25f;
+
+  EntityID particleID = universe.CreateEntityID();
+  Entity particles = Entity(particleID, &universe);
+
+  particles.AddComponent<TransformComponent>();
+  particles.AddComponent<BoundingComponent>();
+  particles.GetComponent<BoundingComponent>()->bound.size = 0.2;
+  particles.AddComponent<FluidComponent>();
+  particles.AddComponent<MeshComponent>();
+  particles.GetComponent<MeshComponent>()->mesh = GenerateSphere(0.1, 4, 4);
+
+  engine.SetupEngineWindow(320, 240, "Spade Sort Benchmark");
+
+  std::cout << std::setw(10) << "N" << std::setw(10) << "Sort" << std::setw(14) << "Dispatches" << std::setw(14) << "GPU ms" << std::endl;
+
+  for (int count : particleCounts) {
+    MeshComponent* meshComponent = particles.GetComponent<MeshComponent>();
+    meshComponent->instanceTransforms.clear();
+    meshComponent->instanceMotions.clear();
+    meshComponent->instanceMaterials.clear();
+    meshComponent->SpawnInstancesInCube(bounds * 1.5f, {0.0, 0.0, 0.0}, count);
+    meshComponent->RandomizeVelocity();
+
+    engine.LoadInstanceBuffers(universe);
+    engine.LoadCollisionBuffers(universe);
+    engine.LoadFluidBuffers(universe);
+    engine.LoadGridBuffers();
+
+    for (int run = 0; run < 3; ++run) {
+      const SortAlgorithm sortAlgorithm = (run == 0) ? BitonicSort : RadixSort;
+      const GridMode gridMode = (run == 2) ? DenseGrid : HashedGrid;
+      engine.SetSortAlgorithm(sortAlgorithm);
+      engine.SetGridMode(gridMode);
+
+      // Sort time is read back one build late, so the first sample belongs to the previous run
+      float totalTime = 0.0f;
+      for (int i = 0; i <= iterations; ++i) {
+        engine.EnableGridCollision(bounds, cellSize);
+        glFinish();
+        if (i > 1) totalTime += engine.GetSortTime();
+      }
+      engine.EnableGridCollision(bounds, cellSize);
+      glFinish();
+      totalTime += engine.GetSortTime();
+
+      std::cout << std::setw(10) << count
+                << std::setw(10) << (gridMode == DenseGrid ? "Counting" : sortAlgorithm == RadixSort ? "Radix" : "Bitonic")
+                << std::setw(14) << engine.GetSortDispatches()
+                << std::setw(14) << std::fixed << std::setprecision(3) << totalTime / iterations << std::endl;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,76 @@
+#include <iostream>
+#include <cstdlib>
+
+#include <Spade/Spade.hpp>
+
+using namespace Spade;
+
+Engine engine;
+Universe universe;
+
+// Fixed-step batch run without a display: Headless [steps] [particles]
+int main(int argc, char** argv) {
+
+  const int steps = (argc > 1) ? std::atoi(argv[1]) : 1000;
+  const int particles = (argc > 2) ? std::atoi(argv[2]) : 50000;
+  const unsigned int substeps = 10;
+  const float deltaTime = 0.016f;
+  const float bounds = 10.0f;
+
+  // Create Particles
+  EntityID fluidID = universe.CreateEntityID();
+  Entity fluid = Entity(fluidID, &universe);
+
+  fluid.AddComponent<TransformComponent>();
+
+  fluid.AddComponent<BoundingComponent>();
+  fluid.GetComponent<BoundingComponent>()->bound.size = 0.2;
+
+  fluid.AddComponent<FluidComponent>();
+  fluid.GetComponent<FluidComponent>()->fluidMaterial.viscosity = 0.5;
+
+  fluid.AddComponent<MeshComponent>();
+  fluid.GetComponent<MeshComponent>()->mesh = GenerateSphere(0.1, 8, 8);
+  fluid.GetComponent<MeshComponent>()->SpawnInstancesInCube(10.0, {3.0, 1.0, -3.0}, particles);
+  fluid.GetComponent<MeshComponent>()->SetMass(0.01);
+  fluid.GetComponent<MeshComponent>()->RandomizeVelocity();
+
+  // Offscreen Context
+  engine.SetupEngineHeadless(640, 480);
+  engine.SetGridMode(DenseGrid);
+
+  engine.LoadInstanceBuffers(universe);
+  engine.LoadCollisionBuffers(universe);
+  engine.LoadFluidBuffers(universe);
+  engine.LoadGridBuffers();
+
+  float start = engine.GetTime();
+
+  // Fixed steps, nothing waits for a display
+  for (int step = 0; step < steps; ++step) {
+    for (unsigned int i = 0; i < substeps; ++i) {
+      engine.EnableGravity(10.0);
+
+      engine.EnableSPHFluid(bounds, 0.25);
+      engine.EnableGridCollision(bounds, 0.25);
+
+      engine.EnableMotion(deltaTime / (float)substeps);
+    }
+
+    engine.RenderColor();
+    engine.DrawScene(universe);
+
+    if (step % 100 == 0) {
+      std::cout << "Step: " << step << " | FPS: " << engine.GetFPS() << " | Mem: " << engine.GetMemory() << " MB" << std::endl;
+    }
+  }
+
+  // Wait for the last frame before timing
+  std::vector<Motion> motions = engine.GetInstanceMotions();
+  float elapsed = engine.GetTime() - start;
+
+  std::cout << steps << " steps of " << motions.size() << " particles in " << elapsed << " s ("
+            << steps / elapsed << " steps / s)" << std::endl;
+
+  return 0;
+}
@@ -74,6 +74,7 @@ int main() {
 
   // Setup Window
   engine.SetupEngineWindow(1920, 1080, "Spade");
+  engine.SetGridMode(DenseGrid);
 
   engine.LoadInstanceBuffers(universe);
   engine.LoadCameraBuffers(universe);
@@ -81,33 +82,42 @@ int main() {
   engine.LoadFluidBuffers(universe);
   engine.LoadGridBuffers();
 
-  // Begin Engine Loop
-  while (engine.IsRunning()) {
-    // FPS / MEMORY counter
-    std::cout << "FPS: " << engine.GetFPS() << " | Mem: " << engine.GetMemory() << " MB" << std::endl;
+  // Frame Systems (every stage here touches GL, so they stay on this thread in registration order)
+  Scheduler scheduler;
 
-    // Process Input
+  scheduler.AddSystem("Input", [&]() {
     engine.ProcessInput(universe);
+  }).Reads<InputComponent>().Writes<TransformComponent, CameraComponent>().OnContextThread();
+
+  scheduler.AddSystem("Physics", [&]() {
+    if (!engine.IsPlaying()) return;
 
-    if (engine.IsPlaying()) {
-      float deltaTime = engine.GetDeltaTime();
-      float substepTime = deltaTime / (float)substeps;
+    float deltaTime = engine.GetDeltaTime();
+    float substepTime = deltaTime / (float)substeps;
 
-      // Update Motion
-      for (int i = 0; i < substeps; ++i) {
-        engine.EnableGravity(10.0);
+    // Update Motion
+    for (int i = 0; i < substeps; ++i) {
+      engine.EnableGravity(10.0);
 
-        engine.EnableSPHFluid(bounds, 0.25);
-        engine.EnableGridCollision(bounds, 0.25);
+      engine.EnableSPHFluid(bounds, 0.25);
+      engine.EnableGridCollision(bounds, 0.25);
 
-        engine.EnableMotion(substepTime);
-      }
+      engine.EnableMotion(substepTime);
     }
+  }).Reads<BoundingComponent, FluidComponent>().Writes<MeshComponent>().OnContextThread();
 
-    // Draw meshes
-    engine.RenderColor();
+  scheduler.AddSystem("Draw", [&]() {
+    // Draw meshes (the particle spheres as impostors)
+    engine.RenderImpostor();
     engine.DrawScene(universe);
+  }).Reads<MeshComponent, CameraComponent>().OnContextThread();
+
+  // Begin Engine Loop
+  while (engine.IsRunning()) {
+    // FPS / MEMORY counter
+    std::cout << "FPS: " << engine.GetFPS() << " | Mem: " << engine.GetMemory() << " MB" << std::endl;
 
+    scheduler.Run();
   }
 
   return 0;
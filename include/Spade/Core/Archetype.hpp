@@ -0,0 +1,210 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+#include <unordered_map>
+
+#include "Spade/Core/Objects.hpp"
+
+namespace Spade {
+
+  // Type-erased column operations of one component type
+  struct ComponentInfo {
+      ComponentTypeID id;
+      size_t size;
+      size_t alignment;
+      void (*moveConstruct)(void* destination, void* source);
+      void (*destroy)(void* object);
+  };
+
+  template<typename T>
+  const ComponentInfo& GetComponentInfo() {
+      static const ComponentInfo info = {
+          GetComponentTypeID<T>(), sizeof(T), alignof(T),
+          [](void* destination, void* source) { new (destination) T(std::move(*static_cast<T*>(source))); },
+          [](void* object) { static_cast<T*>(object)->~T(); }
+      };
+      return info;
+  }
+
+  // Every entity with one exact set of components. Rows are packed into fixed-size chunks laid out
+  // structure-of-arrays: [EntityID x capacity][Column 0 x capacity][Column 1 x capacity]...
+  // All chunks are full except the last, a removed row is filled with the last row.
+  class Archetype {
+  public:
+      static constexpr size_t CHUNK_BYTES = 16384;
+      static constexpr size_t CHUNK_ALIGNMENT = 64;
+
+      explicit Archetype(std::vector<const ComponentInfo*> components);
+      ~Archetype();
+
+      Archetype(const Archetype&) = delete;
+      Archetype& operator=(const Archetype&) = delete;
+
+      // Column of a component type, -1 if the archetype does not have it
+      int ColumnOf(ComponentTypeID id) const;
+
+      void* At(size_t column, size_t row) {
+          const Chunk& chunk = m_Chunks[row / m_ChunkCapacity];
+          return chunk.data.get() + m_ColumnOffsets[column] + (row % m_ChunkCapacity) * m_Components[column]->size;
+      }
+
+      void* ColumnData(size_t column, size_t chunk) { return m_Chunks[chunk].data.get() + m_ColumnOffsets[column]; }
+      EntityID* Entities(size_t chunk) { return reinterpret_cast<EntityID*>(m_Chunks[chunk].data.get()); }
+      size_t ChunkSize(size_t chunk) const { return m_Chunks[chunk].count; }
+
+      // Appends a row for the entity, its components are left unconstructed for the caller
+      size_t AllocateRow(EntityID entity);
+      // Destroys the row's components and fills the hole with the last row, returns the entity moved into it
+      // (INVALID_ENTITY_ID if the row was last)
+      EntityID RemoveRow(size_t row);
+
+      const std::vector<const ComponentInfo*>& GetComponents() const { return m_Components; }
+      size_t GetChunkCount() const { return m_Chunks.size(); }
+      size_t GetChunkCapacity() const { return m_ChunkCapacity; }
+      size_t Size() const { return m_Count; }
+
+      // Neighbouring archetypes one Add / Remove away, filled in as they are first needed
+      std::unordered_map<ComponentTypeID, Archetype*> m_AddEdges;
+      std::unordered_map<ComponentTypeID, Archetype*> m_RemoveEdges;
+
+  private:
+      struct ChunkDeleter {
+          void operator()(std::byte* data) const { ::operator delete(data, std::align_val_t(CHUNK_ALIGNMENT)); }
+      };
+
+      struct Chunk {
+          std::unique_ptr<std::byte, ChunkDeleter> data;
+          size_t count = 0;
+      };
+
+      std::vector<const ComponentInfo*> m_Components; // sorted by ComponentTypeID
+      std::vector<size_t> m_ColumnOffsets;
+      size_t m_ChunkCapacity = 0;
+      size_t m_ChunkBytes = 0;
+
+      std::vector<Chunk> m_Chunks;
+      size_t m_Count = 0;
+  };
+
+  // Optional storage next to the ComponentPools: an entity's components sit together in the chunks of its
+  // archetype, so iterating several components is a linear walk over parallel arrays. Add / Remove move the
+  // entity to the archetype of its new signature. Structural changes are not allowed inside Each / EachChunk.
+  class ArchetypeStorage {
+  public:
+      template<typename T>
+      T& Add(EntityID entity, T component) {
+          const ComponentInfo& info = GetComponentInfo<T>();
+          Location& location = GetLocation(entity);
+
+          if (location.archetype) {
+              const int column = location.archetype->ColumnOf(info.id);
+              if (column >= 0) {
+                  // Replace existing
+                  T& existing = *static_cast<T*>(location.archetype->At(column, location.row));
+                  existing = std::move(component);
+                  return existing;
+              }
+          }
+
+          Archetype* target = FindAddTarget(location.archetype, info);
+          const size_t row = MoveEntity(entity, target);
+
+          T* slot = static_cast<T*>(target->At(target->ColumnOf(info.id), row));
+          new (slot) T(std::move(component));
+          return *slot;
+      }
+
+      template<typename T>
+      void Remove(EntityID entity) {
+          Location* location = FindLocation(entity);
+          if (!location || location->archetype->ColumnOf(GetComponentTypeID<T>()) < 0) return;
+
+          Archetype* target = FindRemoveTarget(location->archetype, GetComponentTypeID<T>());
+          if (target) {
+              MoveEntity(entity, target);
+          } else {
+              RemoveEntity(entity);
+          }
+      }
+
+      template<typename T>
+      T* Get(EntityID entity) {
+          Location* location = FindLocation(entity);
+          if (!location) return nullptr;
+
+          const int column = location->archetype->ColumnOf(GetComponentTypeID<T>());
+          if (column < 0) return nullptr;
+          return static_cast<T*>(location->archetype->At(column, location->row));
+      }
+
+      template<typename T>
+      bool Has(EntityID entity) { return Get<T>(entity) != nullptr; }
+
+      // Drops every component of the entity
+      void RemoveEntity(EntityID entity);
+
+      // Calls function(count, entities, Ts*...) once per chunk holding all Ts, the arrays are count long
+      template<typename... Ts, typename F>
+      void EachChunk(F&& function) {
+          for (const auto& archetype : m_Archetypes) {
+              const std::array<int, sizeof...(Ts)> columns = { archetype->ColumnOf(GetComponentTypeID<Ts>())... };
+              bool match = true;
+              for (int column : columns) match = match && column >= 0;
+              if (!match) continue;
+
+              for (size_t c = 0; c < archetype->GetChunkCount(); ++c) {
+                  InvokeChunk<Ts...>(function, *archetype, c, columns, std::index_sequence_for<Ts...>{});
+              }
+          }
+      }
+
+      // Calls function(EntityID, Ts&...) per entity holding all Ts
+      template<typename... Ts, typename F>
+      void Each(F&& function) {
+          EachChunk<Ts...>([&](size_t count, const EntityID* entities, Ts*... columns) {
+              for (size_t i = 0; i < count; ++i) {
+                  function(entities[i], columns[i]...);
+              }
+          });
+      }
+
+      size_t GetArchetypeCount() const { return m_Archetypes.size(); }
+
+  private:
+      struct Location {
+          Archetype* archetype = nullptr;
+          size_t row = 0;
+          EntityID entity = INVALID_ENTITY_ID;
+      };
+
+      // Entity Index -> Location
+      std::vector<Location> m_Locations;
+
+      std::vector<std::unique_ptr<Archetype>> m_Archetypes;
+      std::map<std::vector<ComponentTypeID>, Archetype*> m_Signatures;
+
+      Location& GetLocation(EntityID entity);
+      Location* FindLocation(EntityID entity);
+
+      Archetype* FindArchetype(std::vector<const ComponentInfo*> components);
+      Archetype* FindAddTarget(Archetype* source, const ComponentInfo& info);
+      Archetype* FindRemoveTarget(Archetype* source, ComponentTypeID id);
+
+      // Moves the entity's shared components into a new row of target, returns the row
+      size_t MoveEntity(EntityID entity, Archetype* target);
+
+      template<typename... Ts, typename F, size_t... I>
+      static void InvokeChunk(F& function, Archetype& archetype, size_t chunk, const std::array<int, sizeof...(Ts)>& columns, std::index_sequence<I...>) {
+          function(archetype.ChunkSize(chunk), static_cast<const EntityID*>(archetype.Entities(chunk)),
+                   static_cast<Ts*>(archetype.ColumnData(columns[I], chunk))...);
+      }
+  };
+
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include "Spade/Core/Enums.hpp"
+#include "Spade/Core/Primitives.hpp"
+#include "Spade/Core/ThreadPool.hpp"
+
+namespace Spade {
+
+  // CPU versions of the compute shader systems, same data and same math.
+  // Grid systems read a sorted SoA snapshot taken by BuildGrid and write straight to the instance arrays,
+  // so they are deterministic for any thread count.
+  class CPUPhysics
+  {
+  public:
+
+    explicit CPUPhysics(unsigned int threadCount = std::thread::hardware_concurrency());
+
+    void EnableMotion(std::vector<Transform>& transforms, std::vector<Motion>& motions, float deltaTime);
+    void EnableGravity(std::vector<Motion>& motions, float globalGravity);
+
+    void EnableBruteForceCollision(std::vector<Transform>& transforms, std::vector<Motion>& motions,
+      const std::vector<unsigned int>& instanceToEntityIndex, const std::vector<Bound>& entityBounds,
+      const std::vector<FluidMaterial>& entityFluidMaterials, float globalBounds);
+
+    // Grid systems need a BuildGrid taken after the last change to positions, velocities or masses
+    void BuildGrid(const std::vector<Transform>& transforms, const std::vector<Motion>& motions,
+      float globalBounds, float cellSize, GridMode gridMode);
+
+    void EnableGridCollision(std::vector<Transform>& transforms, std::vector<Motion>& motions,
+      const std::vector<unsigned int>& instanceToEntityIndex, const std::vector<Bound>& entityBounds,
+      const std::vector<FluidMaterial>& entityFluidMaterials);
+
+    void EnableSPHFluid(std::vector<Motion>& motions, const std::vector<unsigned int>& instanceToEntityIndex,
+      const std::vector<FluidMaterial>& entityFluidMaterials);
+
+    void EnableBarnesHutGravity(const std::vector<Transform>& transforms, std::vector<Motion>& motions,
+      float gravityConstant, float globalBounds, float theta, float softening);
+
+    // LBVH broadphase: Morton-ordered radix tree over the instance AABBs (size / 2 around each position), rebuilt per call
+    void EnableBVHCollision(std::vector<Transform>& transforms, std::vector<Motion>& motions,
+      const std::vector<unsigned int>& instanceToEntityIndex, const std::vector<Bound>& entityBounds,
+      const std::vector<FluidMaterial>& entityFluidMaterials, float globalBounds);
+
+    // Radius, k-nearest and ray queries over the last BuildGrid, hits hold original instance indices
+    void SpatialQueries(const std::vector<SpatialQuery>& queries, SpatialQueryResults& results);
+
+    [[nodiscard]] unsigned int GetThreadCount() const { return m_ThreadPool.GetThreadCount(); }
+    [[nodiscard]] bool IsUsingAVX2() const { return m_UseAVX2; }
+    void SetUseAVX2(bool useAVX2);
+
+  private:
+
+    [[nodiscard]] glm::ivec3 GetGridCell(const glm::vec3& position) const;
+    [[nodiscard]] bool GetCellKey(const glm::ivec3& cell, unsigned int& key) const;
+
+    // Sparse table: unclamped cells packed to 63 bits, open addressing with linear probing
+    [[nodiscard]] static uint64_t PackSparseCell(const glm::ivec3& cell);
+    [[nodiscard]] unsigned int GetSparseHash(uint64_t key) const;
+    unsigned int InsertSparseCell(const glm::ivec3& cell);
+
+    // Calls rangeFunction(start, end) for every occupied neighbour cell range (sorted indices)
+    template <typename F>
+    void ForEachNeighborRange(const glm::vec3& position, F&& rangeFunction) const;
+
+    // Calls instanceFunction(sorted index) for the instances of every cell in [low, high] until it returns false
+    template <typename F>
+    bool ForEachInstanceInCells(const glm::ivec3& low, const glm::ivec3& high, F&& instanceFunction) const;
+
+    // Radix tree shared by Barnes-Hut and the BVH: leaves hold one body (position, mass, point bounds), and
+    // MergeTreeNodes fills the internal nodes bottom-up from whatever the leaves hold
+    void BuildRadixTree(const std::vector<Transform>& transforms, const std::vector<Motion>& motions, float globalBounds);
+    void MergeTreeNodes();
+
+    void ExclusiveScan(std::vector<int>& values);
+    void SortPairs(std::vector<GridPair>& pairs);
+
+    ThreadPool m_ThreadPool;
+    bool m_UseAVX2 = false;
+
+    // Grid (cell ranges [start, end) over the sorted arrays, start is -1 for empty cells)
+    GridMode m_GridMode = HashedGrid;
+    float m_GridBounds = 0.0f;
+    float m_GridCellSize = 1.0f;
+    int m_GridDim = 1;
+    size_t m_TotalCells = 0;
+
+    std::vector<uint64_t> m_SparseKeys;
+    std::vector<unsigned int> m_CellKeys;
+    std::vector<int> m_CellStart;
+    std::vector<int> m_CellEnd;
+    std::vector<unsigned int> m_SortedKeys;
+    std::vector<unsigned int> m_SortedInstances;
+
+    // Sorted Snapshot (SoA)
+    std::vector<float> m_PositionX, m_PositionY, m_PositionZ;
+    std::vector<float> m_VelocityX, m_VelocityY, m_VelocityZ;
+    std::vector<float> m_Mass;
+    std::vector<float> m_Density;
+
+    // Per Sorted Particle Scratch
+    std::vector<float> m_Radius;
+    std::vector<float> m_FluidActive;
+    std::vector<float> m_Pressure;
+    std::vector<float> m_NeighborDensity;
+
+    // Barnes-Hut / BVH Tree (internal nodes [0, N - 1), leaves [N - 1, 2N - 1))
+    std::vector<GridPair> m_MortonPairs;
+    std::vector<BarnesHutNode> m_Nodes;
+    std::vector<unsigned int> m_Parents;
+    std::vector<unsigned int> m_Visits;
+
+  };
+
+}
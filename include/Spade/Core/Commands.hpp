@@ -0,0 +1,98 @@
+#pragma once
+
+#include <vector>
+#include <functional>
+
+#include "Spade/Core/Objects.hpp"
+
+namespace Spade {
+
+  // Entity created by a CommandBuffer, it gets a real EntityID when the buffer is applied
+  struct PendingEntity {
+      unsigned int index;
+  };
+
+  // Records structural changes (create / destroy / add / remove) without touching the Universe, so any thread
+  // can fill its own buffer lock-free. Apply replays them in recording order on one thread at a sync point.
+  class CommandBuffer {
+  public:
+      PendingEntity CreateEntity() {
+          m_Commands.push_back({ CreateCommand, INVALID_ENTITY_ID, m_PendingCount, nullptr });
+          return PendingEntity{ m_PendingCount++ };
+      }
+
+      void DestroyEntity(EntityID entity) {
+          m_Commands.push_back({ DestroyCommand, entity, NOT_PENDING, nullptr });
+      }
+
+      void DestroyEntity(PendingEntity entity) {
+          m_Commands.push_back({ DestroyCommand, INVALID_ENTITY_ID, entity.index, nullptr });
+      }
+
+      template<typename T>
+      void AddComponent(EntityID entity, T component = T()) {
+          m_Commands.push_back({ ComponentCommand, entity, NOT_PENDING, AddFunction(std::move(component)) });
+      }
+
+      template<typename T>
+      void AddComponent(PendingEntity entity, T component = T()) {
+          m_Commands.push_back({ ComponentCommand, INVALID_ENTITY_ID, entity.index, AddFunction(std::move(component)) });
+      }
+
+      template<typename T>
+      void RemoveComponent(EntityID entity) {
+          m_Commands.push_back({ ComponentCommand, entity, NOT_PENDING, RemoveFunction<T>() });
+      }
+
+      template<typename T>
+      void RemoveComponent(PendingEntity entity) {
+          m_Commands.push_back({ ComponentCommand, INVALID_ENTITY_ID, entity.index, RemoveFunction<T>() });
+      }
+
+      // Replays and clears the commands. Operations on entities that are no longer alive are skipped.
+      void Apply(Universe& universe);
+
+      // Applies several buffers in vector order, e.g. one per ParallelFor chunk, so the result does not depend
+      // on which thread filled which buffer
+      static void Apply(std::vector<CommandBuffer>& buffers, Universe& universe);
+
+      // EntityIDs given to the pending entities of the last Apply, by PendingEntity::index
+      [[nodiscard]] const std::vector<EntityID>& GetCreatedEntities() const { return m_Created; }
+
+      [[nodiscard]] bool IsEmpty() const { return m_Commands.empty(); }
+      [[nodiscard]] size_t Size() const { return m_Commands.size(); }
+
+  private:
+      static constexpr unsigned int NOT_PENDING = 0xFFFFFFFF;
+
+      enum CommandType {
+          CreateCommand,
+          DestroyCommand,
+          ComponentCommand,
+      };
+
+      struct Command {
+          CommandType type;
+          EntityID entity;
+          unsigned int pending; // PendingEntity::index, or NOT_PENDING when entity is set
+          std::function<void(Universe&, EntityID)> apply;
+      };
+
+      template<typename T>
+      static std::function<void(Universe&, EntityID)> AddFunction(T component) {
+          return [component = std::move(component)](Universe& universe, EntityID entity) mutable {
+              universe.GetPool<T>().Add(entity, std::move(component));
+          };
+      }
+
+      template<typename T>
+      static std::function<void(Universe&, EntityID)> RemoveFunction() {
+          return [](Universe& universe, EntityID entity) { universe.GetPool<T>().Remove(entity); };
+      }
+
+      std::vector<Command> m_Commands;
+      unsigned int m_PendingCount = 0;
+      std::vector<EntityID> m_Created;
+  };
+
+}
@@ -14,6 +14,7 @@
 
 #include "Spade/Core/Resources.hpp"
 #include "Spade/Core/Primitives.hpp"
+#include "Spade/Core/Objects.hpp"
 #include "Spade/Core/Enums.hpp"
 
 namespace Spade {
@@ -45,11 +46,14 @@ namespace Spade {
 
     unsigned int instanceStartIndex = 0;
 
-    BufferID VAO = 0;
-    BufferID VBO = 0;
-    BufferID EBO = 0;
+    // Change stamp per instance, LoadInstanceBuffers only uploads instances stamped since its last call
+    std::vector<ChangeVersion> instanceVersions;
 
-    ~MeshComponent();
+    void SetInstanceTransform(size_t index, const Transform& transform);
+    void SetInstanceMotion(size_t index, const Motion& motion);
+    void SetInstanceMaterial(size_t index, const Material& material);
+    // Stamps instances written directly through the vectors
+    void MarkInstancesChanged(size_t first, size_t count);
 
     void SpawnInstancesInSphere(float radius, glm::vec3 center, int count);
     void SpawnInstancesInCube(float size, glm::vec3 center, int count);
@@ -61,6 +65,26 @@ namespace Spade {
     void RandomizeColor();
   };
 
+  // Streams new instances of the entity's MeshComponent straight into the instance buffers (Engine::EnableEmitters).
+  // LoadInstanceBuffers reserves capacity slots for them after the mesh's own instances.
+  struct EmitterComponent {
+    unsigned int capacity = 0;
+    float rate = 0.0f;          // Instances per second
+    unsigned int burst = 0;     // Emitted once by the next EnableEmitters
+
+    EmitterShape shape = EmitSphere;
+    glm::vec3 center = {0.0, 0.0, 0.0};
+    float size = 1.0f;          // Sphere radius or cube edge
+
+    glm::vec3 velocity = {0.0, 0.0, 0.0};
+    float speed = 0.0f;         // Random direction on top of velocity
+    float mass = 1.0f;
+    glm::vec4 color = {1.0, 1.0, 1.0, 1.0};
+
+    bool isActive = true;
+    float accumulator = 0.0f;   // Fraction of an instance carried to the next frame
+  };
+
   struct BoundingComponent {
     Bound bound;
   };
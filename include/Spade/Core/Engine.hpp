@@ -5,18 +5,18 @@
 #include <unordered_map>
 #include <tuple>
 #include <memory>
+#include <functional>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
-#include <windows.h>
-#include <psapi.h>
 
 #include "Spade/Core/Primitives.hpp"
 #include "Spade/Core/Objects.hpp"
 #include "Spade/Core/Components.hpp"
 #include "Spade/Core/Resources.hpp"
+#include "Spade/Core/CPUPhysics.hpp"
 
 namespace Spade {
 
@@ -24,10 +24,20 @@ namespace Spade {
   {
   public:
 
+    // Thrown on misuse and setup failures (e.g. loads out of order, a DenseGrid past MAX_DENSE_GRID_CELLS)
+    class EngineException : public std::runtime_error
+    {
+    public:
+      explicit EngineException(const std::string& message);
+    };
+
     ~Engine();
 
     void LoadCameraBuffers(Universe& universe);
     void LoadInstanceBuffers(Universe& universe);
+    // Per-frame path for CPU-authored instances: same meshes and counts as the last load,
+    // written straight into a persistently mapped ring and copied on the GPU
+    void UpdateInstanceBuffers(Universe& universe);
     void LoadCollisionBuffers(Universe& universe);
     void LoadFluidBuffers(Universe& universe);
 
@@ -37,17 +47,70 @@ namespace Spade {
     void EnableGravity(float gravity);
     void EnableMotion(float deltaTime);
 
+    // Emitters: each EmitterComponent adds rate * deltaTime (plus its burst) instances of its mesh, generated on the
+    // device straight into the capacity LoadInstanceBuffers reserved for it
+    void EnableEmitters(Universe& universe, float deltaTime);
+
+    // Compaction: every instance has an alive flag (binding 35 on the device), cleared by kill systems or custom
+    // shaders. CompactInstances removes the dead ones from all instance buffers (scan + scatter, survivors keep their
+    // order) and frees their capacity for the emitters. It reads back two counts per mesh, so call it every few frames.
+    void KillOutOfBounds(float globalBounds);
+    void CompactInstances();
+
+    // Async Readback: instances are gathered on the GPU into a persistently mapped staging buffer guarded by a fence
+    // and picked up frames later, nothing waits. Ranges are in instance order (as GetInstanceMotions); mirrored
+    // readbacks take load order (MeshComponent::instanceStartIndex + local) and are written back by MirrorReadbacks.
+    unsigned int RequestReadback(size_t first, size_t count, bool mirror = false);
+    // False until the fence has passed, then hands the records over once
+    bool TryGetReadback(unsigned int readback, std::vector<ReadbackRecord>& records);
+    // Finished mirrored readbacks overwrite their MeshComponent instances (not marked changed, so nothing re-uploads)
+    void MirrorReadbacks(Universe& universe);
+
+    // Spatial Queries: a batch of radius, k-nearest and ray queries answered by one dispatch over the grid of
+    // BuildGrid(globalBounds, cellSize) (reused while current). Hits are compacted per query and come back like a
+    // readback, with instances in submission order.
+    unsigned int RequestSpatialQueries(const std::vector<SpatialQuery>& queries, float globalBounds, float cellSize);
+    bool TryGetSpatialQueries(unsigned int queries, SpatialQueryResults& results);
+
     void EnableBruteForceCollision(float bounds);
     void EnableGridCollision(float bounds, float cellSize);
+    // LBVH broadphase for mixed sizes: a Morton-ordered radix tree over the instance boxes, rebuilt every call,
+    // finds every overlap whatever the size ratio (O(N log N), no cell size to tune)
+    void EnableBVHCollision(float bounds);
 
     void EnableSPHFluid(float globalBounds, float cellSize);
 
+    // Grid systems share one build until instances move, their results are written back once here
+    // (called automatically by non-grid systems and DrawScene)
+    void ScatterGrid();
+
     void EnableBruteForceNewtonianGravity(float gravityConstant);
+    // Barnes-Hut: Morton-ordered radix tree rebuilt every call, nodes closer than size / theta are opened
+    void EnableBarnesHutGravity(float gravityConstant, float globalBounds, float theta = 0.5f, float softening = 0.01f);
+
+    // Grid Settings
+    void SetSortAlgorithm(SortAlgorithm sortAlgorithm) { m_SortAlgorithm = sortAlgorithm; }
+    // SparseGrid hashes unclamped cells into a table sized to the instance count (no world box, no walls)
+    void SetGridMode(GridMode gridMode) { m_GridMode = gridMode; }
+    // DenseGrid cell limit (65535 groups of 64, the most one grid dispatch is guaranteed to cover), larger grids throw
+    static constexpr size_t MAX_DENSE_GRID_CELLS = 65535 * 64;
+    // FusedFluidKernel: SPH with constants folded per dispatch, per-particle material and pressure packed by the density
+    // pass, and neighbour cells loaded cooperatively into shared memory
+    void SetFluidKernel(FluidKernel fluidKernel) { m_FluidKernel = fluidKernel; }
+    // SpatialOrder keeps the instance buffers themselves in cell order (no gather/scatter per grid pass)
+    void SetInstanceOrder(InstanceOrder instanceOrder) { m_InstanceOrder = instanceOrder; }
+
+    // Device Settings (CPUDevice runs the same systems on a thread pool over the instance caches, no GL context needed)
+    void SetSimulationDevice(SimulationDevice simulationDevice);
+    void SetCPUThreadCount(unsigned int threadCount);
+    void SetCPUUseAVX2(bool useAVX2);
 
     // Render Systems
     void RenderWireframe();
     void RenderColor();
     void RenderVelocity();
+    // Color shading, sphere meshes drawn as camera-facing quads with per-pixel ray-sphere hits
+    void RenderImpostor();
     void RenderShader(const std::string& name, const std::string& fragmentShaderFile, const std::string& geometryShaderFile = "");
 
     // Main functions
@@ -63,6 +126,16 @@ namespace Spade {
     [[nodiscard]] float GetDeltaTime() const { return m_DeltaTime; }
     [[nodiscard]] float GetFPS() const { return m_FPS; }
     [[nodiscard]] float GetMemory() const { return m_Memory; }
+    [[nodiscard]] unsigned int GetSortDispatches() const { return m_SortDispatches; }
+    [[nodiscard]] float GetSortTime() const { return m_SortTime; }
+    // Bytes sent to the GPU by loads and uploads during the last frame
+    [[nodiscard]] size_t GetUploadedBytes() const { return m_FrameUploadedBytes; }
+    [[nodiscard]] std::vector<Motion> GetInstanceMotions();
+    // Live instances (loaded plus emitted) and the most the instance buffers hold
+    [[nodiscard]] size_t GetInstanceCount() const { return m_InstanceCount; }
+    [[nodiscard]] size_t GetInstanceCapacity() const { return m_InstanceCapacity; }
+    [[nodiscard]] size_t GetMeshInstanceCount(size_t meshIndex) const { return m_MeshLoadedCounts[meshIndex] + m_MeshEmittedCounts[meshIndex]; }
+    [[nodiscard]] SimulationDevice GetSimulationDevice() const { return m_SimulationDevice; }
     [[nodiscard]] bool IsKeyPressed(int key) const { return glfwGetKey(m_GLFWwindow, key) == GLFW_PRESS; }
     [[nodiscard]] bool IsPlaying() const { return m_IsPlaying; }
     [[nodiscard]] bool IsMouseButtonPressed(int button) const;
@@ -70,21 +143,129 @@ namespace Spade {
 
     void SetMouseCursorMode();
     void SetupEngineWindow(int width, int height, const std::string& title);
+    // Offscreen context for batch runs without a display (GLFW null platform + EGL, surfaceless on Mesa).
+    // DrawScene renders into a framebuffer and never presents, so nothing waits for vsync.
+    void SetupEngineHeadless(int width, int height);
+    [[nodiscard]] bool IsHeadless() const { return m_Headless; }
 
   private:
 
-    void SetupGLFWandGLADWindow(const int& width, const int& height, const std::string& title);
+    void SetupGLFWandGLADWindow(const int& width, const int& height, const std::string& title, bool headless = false);
+    void CreateOffscreenFramebuffer(int width, int height);
+
+    [[nodiscard]] bool HasContext() const { return m_GLFWwindow != nullptr; }
+    [[nodiscard]] CPUPhysics& GetCPUPhysics();
 
     void SaveRenderToFile(const std::string& fileName);
     void UpdateStatistics();
 
     void BuildGrid(float globalBounds, float cellSize);
+    void InvalidateGrid() { m_InstanceEpoch++; }
+    void BeginSortQuery();
+    void EndSortQuery();
+    void BitonicSortGridPairs(unsigned int sortedSize);
+    // skipSorted: keys already in order (coherent SpatialOrder builds) skip every pass on the GPU, no readback
+    unsigned int RadixSortPairs(const std::string& pairs, unsigned int numKeys, unsigned int keyBits, bool skipSorted = false);
+    unsigned int PrefixScan(const BufferID& buffer, unsigned int count);
+    void PermuteInstances(size_t numInstances);
+
+    struct ReadbackStaging {
+      BufferID buffer = 0;
+      unsigned char* data = nullptr; // Persistently mapped (null without GL 4.4)
+      size_t size = 0;
+    };
+
+    struct PendingReadback {
+      unsigned int id = 0;
+      size_t first = 0;
+      size_t count = 0;
+      bool mirror = false;
+      ReadbackStaging staging;
+      GLsync fence = nullptr;
+      std::vector<ReadbackRecord> records;
+    };
+
+    struct PendingSpatialQueries {
+      unsigned int id = 0;
+      size_t queryCount = 0;
+      ReadbackStaging rangeStaging;
+      ReadbackStaging hitStaging;
+      GLsync fence = nullptr;
+      SpatialQueryResults results;
+    };
+
+    ReadbackStaging AcquireReadbackStaging(size_t size);
+    void ReadReadbackStaging(const ReadbackStaging& staging, void* destination, size_t size);
+    [[nodiscard]] bool PollReadbackFence(GLsync& fence);
+    bool CollectReadback(PendingReadback& readback);
+    bool CollectSpatialQueries(PendingSpatialQueries& queries);
+
+    void ReserveShaderStorageBuffer(const std::string& name, size_t size);
+    void UploadInstanceBuffers();
+    void DownloadInstanceBuffers();
+    void UploadSceneGeometry(Universe& universe);
+    void LoadChangedInstances(Universe& universe);
+    unsigned char* MapUploadRegion(size_t size);
+    void SubmitUploadRegion(const std::vector<std::pair<std::string, size_t>>& targets,
+      const std::function<void(BufferID ring, size_t offset)>& consume = nullptr);
+    void ResizeUploadRing(size_t regionSize);
+    void RotateUploadRegion();
+    void EndUploadFrame();
 
     // Window Variables
     std::string m_WindowTitle;
     glm::vec2 m_WindowSize = {800.0, 600.0};
     GLFWwindow* m_GLFWwindow = nullptr;
 
+    // Headless Target (there is no default framebuffer without a surface)
+    bool m_Headless = false;
+    GLuint m_OffscreenFramebuffer = 0;
+    GLuint m_OffscreenColor = 0;
+    GLuint m_OffscreenDepth = 0;
+
+    // Scene Geometry (every mesh merged into one VAO, drawn by one indirect call)
+    GLuint m_SceneVAO = 0;
+    unsigned int m_SceneMeshCount = 0;
+    unsigned int m_SceneSphereCount = 0;
+    bool m_DrawImpostors = false;
+
+    // Upload Ring (one region per frame in flight, each guarded by a fence, uploads of a frame sub-allocated inside it)
+    static constexpr unsigned int UPLOAD_RING_FRAMES = 3;
+    static constexpr size_t UPLOAD_ALIGNMENT = 256; // Covers GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT
+    unsigned char* m_UploadRingData = nullptr;
+    size_t m_UploadRegionSize = 0;
+    unsigned int m_UploadRegion = 0;
+    bool m_UploadRegionAcquired = false;
+    size_t m_UploadOffset = 0;      // Next free byte of the current region
+    size_t m_UploadCursor = 0;      // Start of the upload being written
+    size_t m_UploadFrameBytes = 0;  // Aligned bytes of this frame, the region grows to fit them at the frame boundary
+    GLsync m_UploadFences[UPLOAD_RING_FRAMES] = {};
+
+    // Readback State (staging buffers of collected readbacks are reused)
+    std::vector<PendingReadback> m_Readbacks;
+    std::vector<PendingSpatialQueries> m_SpatialQueries;
+    std::vector<ReadbackStaging> m_FreeReadbackStaging;
+    unsigned int m_NextReadbackID = 1;
+
+    // Upload State (change stamp each load saw last, and the instance layout it uploaded)
+    ChangeVersion m_InstanceUploadVersion = 0;
+    ChangeVersion m_BoundUploadVersion = 0;
+    ChangeVersion m_FluidUploadVersion = 0;
+    std::vector<size_t> m_MeshInstanceCounts;
+    size_t m_UploadedBytes = 0;
+    size_t m_FrameUploadedBytes = 0;
+
+    // Instance Capacity (live instances come first, emitters fill the rest of each mesh's capacity)
+    size_t m_InstanceCount = 0;
+    size_t m_InstanceCapacity = 0;
+    std::vector<size_t> m_MeshInstanceCapacities;
+    std::vector<size_t> m_MeshEmittedCounts;
+    unsigned int m_EmitSeed = 0;
+
+    // Compaction State (loaded instances come first in original order, emitted ones after them)
+    size_t m_LoadedInstanceCount = 0;
+    std::vector<size_t> m_MeshLoadedCounts;
+
     // Frame Statistics
     bool m_IsPlaying = false;
     bool m_CursorTrapped = false;
@@ -98,11 +279,42 @@ namespace Spade {
     float m_FPS = 0.0f;
     unsigned int m_TotalFrames = 0;
 
+    // Grid Settings
+    GridMode m_GridMode = HashedGrid;
+    FluidKernel m_FluidKernel = SeparateFluidKernel;
+    SortAlgorithm m_SortAlgorithm = RadixSort;
+    InstanceOrder m_InstanceOrder = SubmissionOrder;
+
+    // Grid State (the grid is valid while its epoch matches the instance epoch)
+    unsigned int m_InstanceEpoch = 0;
+    unsigned int m_GridEpoch = 0xFFFFFFFF;
+    GridMode m_GridBuildMode = HashedGrid;
+    InstanceOrder m_GridBuildOrder = SubmissionOrder;
+    float m_GridBounds = 0.0f;
+    float m_GridCellSize = 0.0f;
+    unsigned int m_GridTableSize = 1 << 21;
+    bool m_GridScatterPending = false;
+
+    // Device State (the CPU backend is created on first use)
+    SimulationDevice m_SimulationDevice = GPUDevice;
+    unsigned int m_CPUThreadCount = std::thread::hardware_concurrency();
+    bool m_CPUUseAVX2 = true;
+    std::unique_ptr<CPUPhysics> m_CPUPhysics;
+
+    // Sort Statistics (GPU time of the last finished sort, in milliseconds)
+    unsigned int m_SortDispatches = 0;
+    float m_SortTime = 0.0f;
+    GLuint m_SortQuery = 0;
+
     // --Cache--
     std::vector<Transform> m_InstanceTransforms;
     std::vector<Motion> m_InstanceMotions;
     std::vector<Material> m_InstanceMaterials;
     std::vector<unsigned int> m_InstanceToEntityIndex;
+    std::vector<unsigned int> m_InstanceAlive;
+    std::vector<unsigned int> m_LoadedInstances; // Load index -> original index (INVALID_INSTANCE once removed)
+    std::vector<Bound> m_EntityBounds;
+    std::vector<FluidMaterial> m_EntityFluidMaterials;
 
     CameraComponent m_ActiveCamera{};
 
@@ -112,12 +324,6 @@ namespace Spade {
 
     ProgramID m_ActiveProgram = 0;
 
-    class EngineException : public std::runtime_error
-    {
-    public:
-      explicit EngineException(const std::string& message);
-    };
-
   };
 
 }
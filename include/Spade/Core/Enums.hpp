@@ -7,4 +7,41 @@ enum Input {
   MoveLeft,
   MoveUp,
   MoveDown,
-};
\ No newline at end of file
+};
+
+enum SortAlgorithm {
+  BitonicSort,
+  RadixSort,
+};
+
+enum GridMode {
+  HashedGrid,
+  DenseGrid,
+  SparseGrid,
+};
+
+enum FluidKernel {
+  SeparateFluidKernel,
+  FusedFluidKernel,
+};
+
+enum InstanceOrder {
+  SubmissionOrder,
+  SpatialOrder,
+};
+
+enum SimulationDevice {
+  GPUDevice,
+  CPUDevice,
+};
+
+enum EmitterShape {
+  EmitCube,
+  EmitSphere,
+};
+
+enum SpatialQueryType {
+  QueryRadius,
+  QueryKNearest,
+  QueryRaycast,
+};
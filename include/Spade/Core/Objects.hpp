@@ -1,9 +1,15 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <atomic>
-#include <typeinfo>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include <unordered_map>
 
@@ -14,6 +20,19 @@ namespace Spade {
   using EntityID = unsigned int;
   static const EntityID INVALID_ENTITY_ID = 0xFFFFFFFF;
 
+  // EntityID = generation (high 8 bits) | index (low 24 bits). Pools address their sparse pages by the index,
+  // and a destroyed entity's index comes back with the next generation, so stale handles stop matching.
+  static const unsigned int ENTITY_INDEX_BITS = 24;
+  static const EntityID ENTITY_INDEX_MASK = (1u << ENTITY_INDEX_BITS) - 1;
+  static const EntityID MAX_ENTITIES = ENTITY_INDEX_MASK; // index 0xFFFFFF is never handed out, so no ID equals INVALID_ENTITY_ID
+
+  inline EntityID GetEntityIndex(EntityID entity) { return entity & ENTITY_INDEX_MASK; }
+  inline EntityID GetEntityGeneration(EntityID entity) { return entity >> ENTITY_INDEX_BITS; }
+  inline EntityID MakeEntityID(EntityID index, EntityID generation) { return (generation << ENTITY_INDEX_BITS) | (index & ENTITY_INDEX_MASK); }
+
+  // Stamp from one global clock, a consumer uploads whatever is stamped after its last upload
+  using ChangeVersion = unsigned long long;
+
   // Basic parent object
   class Object {
   public:
@@ -32,12 +51,25 @@ namespace Spade {
   };
 
   namespace Internal {
+      // Dense IDs handed out on first use, so pools and views index flat arrays
       ComponentTypeID GetUniqueComponentID();
+      ComponentTypeID GetUniqueViewID();
+
+      // Advances the change clock and returns the new stamp
+      ChangeVersion NextChangeVersion();
+      // Latest stamp handed out
+      ChangeVersion GetChangeVersion();
   }
 
   template<typename T>
     inline ComponentTypeID GetComponentTypeID() {
-    static ComponentTypeID typeID = typeid(T).hash_code();
+    static const ComponentTypeID typeID = Internal::GetUniqueComponentID();
+    return typeID;
+  }
+
+  template<typename T>
+    inline ComponentTypeID GetViewTypeID() {
+    static const ComponentTypeID typeID = Internal::GetUniqueViewID();
     return typeID;
   }
 
@@ -56,88 +88,287 @@ namespace Spade {
       // Dense Index -> EntityID (for reverse lookup during iteration)
       std::vector<EntityID> m_IndexToEntity;
 
-      // Sparse EntityID -> Index (Direct Lookup)
-      // If m_EntityToIndex[entityID] == INVALID_INDEX, it has no component.
-      // We reserve enough space for max entities.
-      std::vector<size_t> m_EntityToIndex;
-      
-      static constexpr size_t INVALID_INDEX = 0xFFFFFFFF;
+      // Sparse EntityID -> Index, in fixed pages allocated on the first Add that touches them.
+      // Entity index i lives at m_Pages[i / PAGE_SIZE][i % PAGE_SIZE], a missing page means no entity in it has the component.
+      static constexpr size_t PAGE_SIZE = 4096;
+      using Page = std::array<std::uint32_t, PAGE_SIZE>;
+      std::vector<std::unique_ptr<Page>> m_Pages;
 
-      ComponentPool() {
-          // Reserve space for a reasonable amount of entities to avoid reallocs
-          // In a production engine, this would be a Page allocator or huge reserve.
-          m_EntityToIndex.resize(10000, INVALID_INDEX); 
-      }
+      // Dense Index -> last change stamp (Add, MarkChanged), and the stamp of the last Add / Remove
+      std::vector<ChangeVersion> m_Versions;
+      ChangeVersion m_StructureVersion = 0;
+      
+      static constexpr std::uint32_t INVALID_INDEX = 0xFFFFFFFF;
 
       T& Add(EntityID entity, T component) {
-          if (Has(entity)) {
-              // Replace existing
-              m_Data[m_EntityToIndex[entity]] = std::move(component);
-              return m_Data[m_EntityToIndex[entity]];
-          }
-
-          // Ensure Sparse Array is big enough
-          if (entity >= m_EntityToIndex.size()) {
-              m_EntityToIndex.resize(entity + 1000, INVALID_INDEX);
+          std::uint32_t& slot = SparseSlot(entity);
+          if (slot != INVALID_INDEX) {
+              // Replace existing (the handle passed in owns the slot from now on)
+              m_Data[slot] = std::move(component);
+              m_IndexToEntity[slot] = entity;
+              m_Versions[slot] = Internal::NextChangeVersion();
+              return m_Data[slot];
           }
 
-          size_t index = m_Data.size();
+          slot = static_cast<std::uint32_t>(m_Data.size());
           m_Data.push_back(std::move(component));
           m_IndexToEntity.push_back(entity);
-          m_EntityToIndex[entity] = index;
+          m_Versions.push_back(Internal::NextChangeVersion());
+          m_StructureVersion = m_Versions.back();
           
           return m_Data.back();
       }
 
       void Remove(EntityID entity) override {
-          if (!Has(entity)) return;
+          const std::uint32_t indexToRemove = IndexOf(entity);
+          if (indexToRemove == INVALID_INDEX) return;
 
-          size_t indexToRemove = m_EntityToIndex[entity];
-          size_t lastIndex = m_Data.size() - 1;
+          const std::uint32_t lastIndex = static_cast<std::uint32_t>(m_Data.size() - 1);
           EntityID lastEntity = m_IndexToEntity[lastIndex];
 
           // Swap-and-pop Dense Data
           m_Data[indexToRemove] = std::move(m_Data[lastIndex]);
           m_IndexToEntity[indexToRemove] = lastEntity;
+          m_Versions[indexToRemove] = m_Versions[lastIndex];
 
-          // Update Sparse Map
-          m_EntityToIndex[lastEntity] = indexToRemove;
-          m_EntityToIndex[entity] = INVALID_INDEX;
+          // Update Sparse Map (both pages exist, each entity is in the pool)
+          SparseSlot(lastEntity) = indexToRemove;
+          SparseSlot(entity) = INVALID_INDEX;
 
           m_Data.pop_back();
           m_IndexToEntity.pop_back();
+          m_Versions.pop_back();
+          m_StructureVersion = Internal::NextChangeVersion();
+      }
+
+      void MarkChanged(EntityID entity) {
+          const std::uint32_t index = IndexOf(entity);
+          if (index == INVALID_INDEX) return;
+          m_Versions[index] = Internal::NextChangeVersion();
+      }
+
+      // Dense index of the entity's component, INVALID_INDEX if it has none (or the handle is of an older generation)
+      std::uint32_t IndexOf(EntityID entity) const {
+          const EntityID entityIndex = GetEntityIndex(entity);
+          const size_t page = entityIndex / PAGE_SIZE;
+          if (page >= m_Pages.size() || !m_Pages[page]) return INVALID_INDEX;
+
+          const std::uint32_t index = (*m_Pages[page])[entityIndex % PAGE_SIZE];
+          if (index == INVALID_INDEX || m_IndexToEntity[index] != entity) return INVALID_INDEX;
+          return index;
       }
 
       T* Get(EntityID entity) {
-          if (entity >= m_EntityToIndex.size()) return nullptr;
-          size_t index = m_EntityToIndex[entity];
+          const std::uint32_t index = IndexOf(entity);
           if (index == INVALID_INDEX) return nullptr;
           return &m_Data[index];
       }
       
       bool Has(EntityID entity) const {
-          if (entity >= m_EntityToIndex.size()) return false;
-          return m_EntityToIndex[entity] != INVALID_INDEX;
+          return IndexOf(entity) != INVALID_INDEX;
+      }
+
+      // Bytes held by the sparse pages and their table
+      size_t GetSparseMemory() const {
+          size_t pages = 0;
+          for (const auto& page : m_Pages) pages += (page != nullptr);
+          return pages * sizeof(Page) + m_Pages.capacity() * sizeof(std::unique_ptr<Page>);
+      }
+
+  private:
+      // Sparse entry of an entity, allocating its page on first touch
+      std::uint32_t& SparseSlot(EntityID entity) {
+          const EntityID entityIndex = GetEntityIndex(entity);
+          const size_t page = entityIndex / PAGE_SIZE;
+          if (page >= m_Pages.size()) {
+              m_Pages.resize(page + 1);
+          }
+          if (!m_Pages[page]) {
+              m_Pages[page] = std::make_unique<Page>();
+              m_Pages[page]->fill(INVALID_INDEX);
+          }
+          return (*m_Pages[page])[entityIndex % PAGE_SIZE];
       }
   };
 
+  // Component types a view skips, e.g. universe.View<TransformComponent>(Exclude<InputComponent>{})
+  template<typename... Es>
+  struct Exclude {};
+
+  class IComponentView {
+  public:
+      virtual ~IComponentView() = default;
+  };
+
+  template<typename Excluded, typename... Ts>
+  class ComponentView;
+
+  // Entities holding every Ts and none of the Es. The matches are cached as dense indices into each pool,
+  // found by walking the smallest pool, and rebuilt only after an Add / Remove in any pool involved.
+  template<typename... Es, typename... Ts>
+  class ComponentView<Exclude<Es...>, Ts...> : public IComponentView {
+  public:
+      static_assert(sizeof...(Ts) > 0, "ComponentView needs at least one component type");
+
+      ComponentView(ComponentPool<Ts>&... pools, ComponentPool<Es>&... excluded)
+        : m_Pools(&pools...), m_Excluded(&excluded...)
+      { }
+
+      // Calls function(EntityID, Ts&...) per match, a function returning bool stops on false
+      template<typename F>
+      void Each(F&& function) {
+          Refresh();
+          for (size_t m = 0; m < m_Entities.size(); ++m) {
+              if constexpr (std::is_same_v<std::invoke_result_t<F&, EntityID, Ts&...>, bool>) {
+                  if (!Invoke(function, m, std::index_sequence_for<Ts...>{})) return;
+              } else {
+                  Invoke(function, m, std::index_sequence_for<Ts...>{});
+              }
+          }
+      }
+
+      size_t Size() { Refresh(); return m_Entities.size(); }
+
+      const std::vector<EntityID>& Entities() { Refresh(); return m_Entities; }
+
+  private:
+      std::tuple<ComponentPool<Ts>*...> m_Pools;
+      std::tuple<ComponentPool<Es>*...> m_Excluded;
+
+      // Match -> EntityID, and its dense index in each pool (in Ts order)
+      std::vector<EntityID> m_Entities;
+      std::vector<std::array<std::uint32_t, sizeof...(Ts)>> m_Indices;
+
+      ChangeVersion m_BuildVersion = 0;
+      bool m_Built = false;
+      std::mutex m_RefreshMutex;
+
+      template<typename F, size_t... I>
+      decltype(auto) Invoke(F& function, size_t match, std::index_sequence<I...>) {
+          return function(m_Entities[match], std::get<I>(m_Pools)->m_Data[m_Indices[match][I]]...);
+      }
+
+      void Refresh() {
+          // Concurrent readers (scheduler systems that only read) may reach a stale view together
+          std::lock_guard<std::mutex> lock(m_RefreshMutex);
+
+          // 1. Structure Version (the newest Add / Remove in any pool involved)
+          ChangeVersion version = 0;
+          std::apply([&](auto*... pools) { ((version = std::max(version, pools->m_StructureVersion)), ...); }, m_Pools);
+          std::apply([&](auto*... pools) { ((version = std::max(version, pools->m_StructureVersion)), ...); }, m_Excluded);
+
+          if (m_Built && version <= m_BuildVersion) return;
+          m_Built = true;
+          m_BuildVersion = version;
+
+          // 2. Smallest Pool drives the walk
+          const std::vector<EntityID>* driver = nullptr;
+          std::apply([&](auto*... pools) {
+              ((driver = (!driver || pools->m_IndexToEntity.size() < driver->size()) ? &pools->m_IndexToEntity : driver), ...);
+          }, m_Pools);
+
+          // 3. Matches
+          m_Entities.clear();
+          m_Indices.clear();
+          for (EntityID entity : *driver) {
+              std::array<std::uint32_t, sizeof...(Ts)> indices;
+              bool match = true;
+
+              std::apply([&](auto*... pools) {
+                  size_t i = 0;
+                  ((match = match && (indices[i++] = pools->IndexOf(entity)) != ComponentPool<Ts>::INVALID_INDEX), ...);
+              }, m_Pools);
+              std::apply([&](auto*... pools) { ((match = match && !pools->Has(entity)), ...); }, m_Excluded);
+
+              if (!match) continue;
+              m_Entities.push_back(entity);
+              m_Indices.push_back(indices);
+          }
+      }
+  };
+
+  class ArchetypeStorage;
+
   class Universe : public Object {
   public:
-      std::unordered_map<ComponentTypeID, std::unique_ptr<IComponentPool>> m_Pools;
+      Universe();
+      ~Universe();
 
+      // Component Type ID -> Pool (null until the type's first GetPool)
+      std::vector<std::unique_ptr<IComponentPool>> m_Pools;
+
+      // The reference stays valid for the life of the Universe, so hot loops can hold on to it.
+      // The lookup is locked, so systems running concurrently may create pools on first access.
       template<typename T>
       ComponentPool<T>& GetPool() {
-          ComponentTypeID id = GetComponentTypeID<T>();
-          if (m_Pools.find(id) == m_Pools.end()) {
+          const ComponentTypeID id = GetComponentTypeID<T>();
+          std::lock_guard<std::mutex> lock(m_LookupMutex);
+          if (id >= m_Pools.size()) {
+              m_Pools.resize(id + 1);
+          }
+          if (!m_Pools[id]) {
               m_Pools[id] = std::make_unique<ComponentPool<T>>();
           }
           return static_cast<ComponentPool<T>&>(*m_Pools[id]);
       }
-      
-      EntityID m_NextEntityID = 0;
-      EntityID CreateEntityID() { return m_NextEntityID++; }
+
+      // Several pools at once: auto [meshPool, boundingPool] = universe.GetPools<MeshComponent, BoundingComponent>();
+      template<typename... Ts>
+      std::tuple<ComponentPool<Ts>&...> GetPools() {
+          return std::tuple<ComponentPool<Ts>&...>(GetPool<Ts>()...);
+      }
+
+      // View Type ID -> View, views persist here so their matches stay cached between calls
+      std::vector<std::unique_ptr<IComponentView>> m_Views;
+
+      // Guards the lazy creation in GetPool / View
+      std::mutex m_LookupMutex;
+
+      template<typename... Ts, typename... Es>
+      ComponentView<Exclude<Es...>, Ts...>& View(Exclude<Es...> = {}) {
+          using ViewType = ComponentView<Exclude<Es...>, Ts...>;
+          const ComponentTypeID id = GetViewTypeID<ViewType>();
+
+          // Pools first (each lookup takes the lock itself)
+          std::tuple<ComponentPool<Ts>&..., ComponentPool<Es>&...> pools(GetPool<Ts>()..., GetPool<Es>()...);
+
+          std::lock_guard<std::mutex> lock(m_LookupMutex);
+          if (id >= m_Views.size()) {
+              m_Views.resize(id + 1);
+          }
+          if (!m_Views[id]) {
+              m_Views[id] = std::apply([](auto&... pool) { return std::make_unique<ViewType>(pool...); }, pools);
+          }
+          return static_cast<ViewType&>(*m_Views[id]);
+      }
+
+      // Entity Index -> its live EntityID (current generation), and the indices of destroyed entities for reuse
+      std::vector<EntityID> m_Entities;
+      std::vector<EntityID> m_FreeIndices;
+
+      // Reuses the most recently freed index (next generation) before growing
+      EntityID CreateEntityID();
+      std::vector<EntityID> CreateEntityIDs(size_t count);
+
+      // Removes the entity from every pool (and the archetype storage) and frees its index, stale or invalid handles are ignored
+      void DestroyEntity(EntityID entity);
+      void DestroyEntities(const std::vector<EntityID>& entities);
+
+      bool IsAlive(EntityID entity) const {
+          const EntityID index = GetEntityIndex(entity);
+          return entity != INVALID_ENTITY_ID && index < m_Entities.size() && m_Entities[index] == entity;
+      }
+
+      size_t GetEntityCount() const { return m_Entities.size() - m_FreeIndices.size(); }
+
+      // Optional chunked SoA storage (Spade/Core/Archetype.hpp), created on first use. It shares the entity IDs
+      // but not the components: the pools and the archetypes each hold what was added to them.
+      ArchetypeStorage& GetArchetypes();
       
       // Clear function?
+
+  private:
+      std::unique_ptr<ArchetypeStorage> m_Archetypes;
   };
 
   class Entity : public Object {
@@ -150,13 +381,18 @@ namespace Spade {
 
       EntityID GetID() const { return m_Id; }
       bool IsValid() const { return m_Id != INVALID_ENTITY_ID && m_Universe != nullptr; }
+      bool IsAlive() const { return IsValid() && m_Universe->IsAlive(m_Id); }
+
+      void Destroy() {
+          if (IsValid()) m_Universe->DestroyEntity(m_Id);
+      }
 
       bool operator==(const Entity& other) const { return m_Id == other.m_Id && m_Universe == other.m_Universe; }
       bool operator!=(const Entity& other) const { return !(*this == other); }
 
       template<typename T>
       T* AddComponent(T component = T()) {
-          if (!IsValid()) return nullptr;
+          if (!IsAlive()) return nullptr;
           return &m_Universe->GetPool<T>().Add(m_Id, std::move(component));
       }
 
@@ -165,6 +401,15 @@ namespace Spade {
           if (!IsValid()) return nullptr;
           return m_Universe->GetPool<T>().Get(m_Id);
       }
+
+      // GetComponent that also marks the component changed, so the next Load*Buffers uploads it
+      // (writes through GetComponent are not tracked)
+      template<typename T>
+      T* MutateComponent() {
+          if (!IsValid()) return nullptr;
+          m_Universe->GetPool<T>().MarkChanged(m_Id);
+          return m_Universe->GetPool<T>().Get(m_Id);
+      }
       
       template<typename T>
       bool HasComponent() {
@@ -78,6 +78,9 @@ namespace Spade {
   struct Mesh {
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
+
+    // Set by GenerateSphere, RenderImpostor draws these meshes as ray-traced quads
+    float sphereRadius = 0.0f;
   };
 
   struct Material {
@@ -108,6 +111,16 @@ namespace Spade {
     unsigned int instanceID; 
   };
 
+  // Radix tree node (leaves: left = -1, right = instance)
+  struct BarnesHutNode {
+    glm::vec3 centerOfMass;
+    float mass;
+    glm::vec3 boundsMin;
+    int left;
+    glm::vec3 boundsMax;
+    int right;
+  };
+
   struct Transform {
     glm::vec3 position = {0.0, 0.0, 0.0};
     float padding;
@@ -142,6 +155,101 @@ namespace Spade {
     unsigned int instanceIndex;
   };
 
+  // One mesh inside the merged scene geometry (indices are local to the mesh, baseVertex offsets them)
+  struct MeshDraw {
+    unsigned int indexCount;
+    unsigned int firstIndex;
+    int baseVertex;
+    unsigned int instanceStart;
+    float boundingRadius;
+    unsigned int commandIndex;
+  };
+
+  // One changed instance, written to its current slot by InstanceUpdate.comp
+  struct InstanceUpdate {
+    Transform transform;
+    Motion motion;
+    Material material;
+    unsigned int instanceIndex;
+    unsigned int padding[3];
+  };
+
+  // One sorted particle as packed by FluidDensityFused.comp for FluidForceFused.comp (material, density and both
+  // pressures resolved once per particle instead of once per neighbour)
+  struct FluidParticle {
+    glm::vec3 position;
+    float mass;
+    glm::vec3 velocity;
+    float viscosity;
+    float density;
+    float pressure;
+    float neighborDensity;
+    float neighborPressure;
+    unsigned int active;
+    unsigned int padding[3];
+  };
+
+  // One instance copied back by Readback.comp (instanceIndex is INVALID for instances compaction removed)
+  struct ReadbackRecord {
+    Transform transform;
+    Motion motion;
+    unsigned int instanceIndex;
+    unsigned int padding[3];
+  };
+
+  // One query of a spatial query batch (SpatialQueryType). Raycasts treat every instance as a sphere of radius,
+  // at most cellSize / 2 so the grid neighbourhood of the ray covers it; k-nearest keeps at most 16.
+  struct SpatialQuery {
+    glm::vec3 origin = {0.0, 0.0, 0.0};
+    float radius = 1.0f;
+    glm::vec3 direction = {0.0, 0.0, 1.0};
+    float maxDistance = 1000.0f;
+    unsigned int type = 0;
+    unsigned int maxResults = 64;
+    unsigned int padding[2];
+  };
+
+  struct SpatialHit {
+    unsigned int instanceIndex;
+    float distance;
+  };
+
+  struct SpatialQueryRange {
+    unsigned int first;
+    unsigned int count;
+  };
+
+  // Query q owns hits [ranges[q].first, ranges[q].first + ranges[q].count), nearest first except for radius queries
+  struct SpatialQueryResults {
+    std::vector<SpatialQueryRange> ranges;
+    std::vector<SpatialHit> hits;
+  };
+
+  // Instances one emitter adds this frame, generated into slots taken from the instance counter by Emit.comp
+  struct EmitRecord {
+    glm::vec3 center;
+    float size;
+    glm::vec3 velocity;
+    float speed;
+    glm::vec4 color;
+    unsigned int entityIndex;
+    unsigned int first;
+    unsigned int count;
+    unsigned int shape;
+    unsigned int seed;
+    float mass;
+    unsigned int padding[2];
+  };
+
+  // Layout read by glMultiDrawElementsIndirect
+  struct DrawElementsIndirectCommand {
+    unsigned int count;
+    unsigned int instanceCount;
+    unsigned int firstIndex;
+    int baseVertex;
+    unsigned int baseInstance;
+  };
+
   Mesh GenerateQuad(float size);
   Mesh GenerateCube(float size);
   Mesh GenerateSphere(float radius, int sectors, int stacks);
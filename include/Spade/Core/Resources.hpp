@@ -38,17 +38,47 @@
 #ifndef GL_READ_WRITE
 #define GL_READ_WRITE 0x88BA
 #endif
+#ifndef GL_BUFFER_UPDATE_BARRIER_BIT
+#define GL_BUFFER_UPDATE_BARRIER_BIT 0x00000200
+#endif
+#ifndef GL_COMMAND_BARRIER_BIT
+#define GL_COMMAND_BARRIER_BIT 0x00000040
+#endif
+#ifndef GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT
+#define GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT 0x00000001
+#endif
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+#ifndef GL_DISPATCH_INDIRECT_BUFFER
+#define GL_DISPATCH_INDIRECT_BUFFER 0x90EE
+#endif
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#ifndef GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT
+#define GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT 0x00004000
+#endif
 
 // Typedefs (suffixed to avoid collision if glad has them but hides them)
 typedef void (APIENTRY *MY_PFNGLTEXSTORAGE2DPROC) (GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height);
 typedef void (APIENTRY *MY_PFNGLBINDIMAGETEXTUREPROC) (GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format);
 typedef void (APIENTRY *MY_PFNGLDISPATCHCOMPUTEPROC) (GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
+typedef void (APIENTRY *MY_PFNGLDISPATCHCOMPUTEINDIRECTPROC) (GLintptr indirect);
 typedef void (APIENTRY *MY_PFNGLMEMORYBARRIERPROC) (GLbitfield barriers);
+typedef void (APIENTRY *MY_PFNGLMULTIDRAWELEMENTSINDIRECTPROC) (GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+typedef void (APIENTRY *MY_PFNGLBUFFERSTORAGEPROC) (GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
 
 static MY_PFNGLTEXSTORAGE2DPROC glTexStorage2D = nullptr;
 static MY_PFNGLBINDIMAGETEXTUREPROC glBindImageTexture = nullptr;
 static MY_PFNGLDISPATCHCOMPUTEPROC glDispatchCompute = nullptr;
+static MY_PFNGLDISPATCHCOMPUTEINDIRECTPROC glDispatchComputeIndirect = nullptr;
 static MY_PFNGLMEMORYBARRIERPROC glMemoryBarrier = nullptr;
+static MY_PFNGLMULTIDRAWELEMENTSINDIRECTPROC glMultiDrawElementsIndirect = nullptr;
+static MY_PFNGLBUFFERSTORAGEPROC glBufferStorage = nullptr;
 
 namespace Spade {
 
@@ -75,6 +105,8 @@ namespace Spade {
       glBufferData(GL_SHADER_STORAGE_BUFFER, data.size() * sizeof(T), data.data(), GL_DYNAMIC_DRAW);
     };
 
+    static void AllocateShaderStorageBufferObject(size_t size, const BufferID& SSBO);
+
     template <typename T>
     static void UploadUniformBufferObject(const T& object, const BufferID& UBO) {
       glBindBuffer(GL_UNIFORM_BUFFER, UBO);
@@ -91,12 +123,31 @@ namespace Spade {
       glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, objects.size() * sizeof(T), objects.data());
     };
 
+    template <typename T>
+    static void UpdateShaderStorageBufferObject(const T* objects, size_t count, size_t firstObject, const BufferID& SSBO) {
+      glBindBuffer(GL_SHADER_STORAGE_BUFFER, SSBO);
+      glBufferSubData(GL_SHADER_STORAGE_BUFFER, firstObject * sizeof(T), count * sizeof(T), objects);
+    };
+
     template <typename T>
     static void UpdateUniformBufferObject(const T& object, const BufferID& UBO) {
       glBindBuffer(GL_UNIFORM_BUFFER, UBO);
       glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(T), &object);
     };
 
+    // Buffer Downloading (blocks until the GPU is done with the buffer)
+    template <typename T>
+    static void DownloadShaderStorageBufferObject(std::vector<T>& objects, const BufferID& SSBO) {
+      glBindBuffer(GL_SHADER_STORAGE_BUFFER, SSBO);
+      glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, objects.size() * sizeof(T), objects.data());
+    };
+
+    // Buffer Copying
+    static void CopyBufferObject(const BufferID& source, const BufferID& destination, size_t size, size_t readOffset = 0, size_t writeOffset = 0);
+
+    // Buffer Queries
+    static size_t GetBufferObjectSize(const BufferID& bufferID);
+
     // Uniform Setting
     static GLuint GetUniformLocation(ProgramID programID, const GLchar *name) { return glGetUniformLocation(programID, name); }
 
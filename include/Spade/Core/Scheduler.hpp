@@ -0,0 +1,87 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <functional>
+
+#include "Spade/Core/Objects.hpp"
+#include "Spade/Core/Commands.hpp"
+#include "Spade/Core/ThreadPool.hpp"
+
+namespace Spade {
+
+  // Runs registered systems once per Run(). Two systems conflict when one writes a type the other reads or writes,
+  // and conflicting systems keep their registration order. Everything else runs concurrently on the work-stealing pool.
+  // Any type can be declared, not just components (e.g. Writes<Engine>() for systems sharing engine state).
+  class Scheduler
+  {
+  public:
+
+    class System
+    {
+    public:
+
+      // Readers of a type run alongside each other. Universe::GetPool / View and view refreshes are locked for this,
+      // but a reader must not change the data itself (MarkChanged and MutateComponent write, declare Writes for them)
+      template<typename... Ts>
+      System& Reads() { (m_Reads.push_back(GetComponentTypeID<Ts>()), ...); return *this; }
+
+      template<typename... Ts>
+      System& Writes() { (m_Writes.push_back(GetComponentTypeID<Ts>()), ...); return *this; }
+
+      // GL stages: run on the thread calling Run (the context thread), one at a time in registration order.
+      // Pool systems that do not conflict with them still run concurrently.
+      System& OnContextThread() { m_ContextThread = true; return *this; }
+
+      System& SetEnabled(bool enabled) { m_Enabled = enabled; return *this; }
+
+      [[nodiscard]] const std::string& GetName() const { return m_Name; }
+      [[nodiscard]] bool IsEnabled() const { return m_Enabled; }
+
+      // Structural changes recorded by the system, applied by Run(Universe&)
+      [[nodiscard]] CommandBuffer& GetCommands() { return m_Commands; }
+
+    private:
+      friend class Scheduler;
+
+      std::string m_Name;
+      std::function<void()> m_Run;
+      CommandBuffer m_Commands;
+      std::vector<ComponentTypeID> m_Reads;
+      std::vector<ComponentTypeID> m_Writes;
+      bool m_ContextThread = false;
+      bool m_Enabled = true;
+    };
+
+    explicit Scheduler(unsigned int threadCount = std::thread::hardware_concurrency());
+
+    // The reference stays valid, declare the access on it: AddSystem("Input", ...).Reads<InputComponent>().Writes<TransformComponent>()
+    System& AddSystem(const std::string& name, std::function<void()> run);
+    // A system that spawns or destroys entities records into its own CommandBuffer instead of touching the pools
+    System& AddSystem(const std::string& name, std::function<void(CommandBuffer&)> run);
+    System* GetSystem(const std::string& name);
+
+    // Builds the dependency graph of the enabled systems and runs it, returns when every system has finished.
+    // The first exception thrown by a system is rethrown here once the others are done.
+    void Run();
+    // Run, then applies every system's CommandBuffer in registration order (the sync point), so the result
+    // does not depend on which systems ran concurrently
+    void Run(Universe& universe);
+
+    [[nodiscard]] unsigned int GetThreadCount() const { return m_ThreadPool.GetThreadCount(); }
+    // Longest chain of dependent systems in the last Run (1 when nothing conflicted)
+    [[nodiscard]] size_t GetCriticalPathLength() const { return m_CriticalPathLength; }
+
+  private:
+
+    [[nodiscard]] static bool Conflicts(const System& a, const System& b);
+
+    std::vector<std::unique_ptr<System>> m_Systems;
+    ThreadPool m_ThreadPool;
+    size_t m_CriticalPathLength = 0;
+
+  };
+
+}
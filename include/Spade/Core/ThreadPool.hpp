@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+
+namespace Spade {
+
+  // Work-stealing pool: every worker owns a queue, pops its own work from the back and steals from the front of others
+  class ThreadPool
+  {
+  public:
+
+    explicit ThreadPool(unsigned int threadCount = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Splits [begin, end) into chunks of at most grainSize, runs task(chunkBegin, chunkEnd) on the pool and waits.
+    // The calling thread works (steals) too, so nested calls from inside a task cannot deadlock.
+    // The first exception thrown by a chunk is rethrown here once every chunk has finished.
+    void ParallelFor(size_t begin, size_t end, size_t grainSize, const std::function<void(size_t, size_t)>& task);
+
+    // Queues one task without waiting for it, a worker (or a thread calling RunPendingTask) picks it up.
+    // An exception thrown by the task is kept for RethrowTaskError instead of ending the worker.
+    void Submit(std::function<void()> task);
+
+    // Runs one queued task on the calling thread, its own queue first (a worker's, or queue 0 for any other
+    // thread) then stealing. False if nothing was queued.
+    bool RunPendingTask();
+
+    // Rethrows, once, the first exception thrown by a submitted task since the last call
+    void RethrowTaskError();
+
+    [[nodiscard]] unsigned int GetThreadCount() const { return (unsigned int)m_Threads.size() + 1; }
+
+  private:
+
+    using Task = std::function<void()>;
+
+    struct WorkQueue {
+      std::mutex mutex;
+      std::deque<Task> tasks;
+    };
+
+    void WorkerLoop(unsigned int index);
+    bool PopTask(unsigned int index, Task& task);
+    bool StealTask(unsigned int thief, Task& task);
+
+    std::vector<std::unique_ptr<WorkQueue>> m_Queues;
+    std::vector<std::thread> m_Threads;
+
+    std::mutex m_WakeMutex;
+    std::condition_variable m_WakeCondition;
+    std::atomic<size_t> m_QueuedTasks = 0;
+    std::atomic<unsigned int> m_NextQueue = 0;
+    bool m_Stopping = false;
+
+    std::mutex m_ErrorMutex;
+    std::exception_ptr m_TaskError;
+
+  };
+
+}
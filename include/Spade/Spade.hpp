@@ -2,6 +2,11 @@
 
 #include "Spade/Core/Engine.hpp"
 #include "Spade/Core/Objects.hpp"
+#include "Spade/Core/Archetype.hpp"
+#include "Spade/Core/Commands.hpp"
 #include "Spade/Core/Components.hpp"
 #include "Spade/Core/Primitives.hpp"
 #include "Spade/Core/Resources.hpp"
+#include "Spade/Core/ThreadPool.hpp"
+#include "Spade/Core/Scheduler.hpp"
+#include "Spade/Core/CPUPhysics.hpp"
@@ -0,0 +1,190 @@
+#include "Spade/Core/Archetype.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Spade {
+
+  Archetype::Archetype(std::vector<const ComponentInfo*> components)
+    : m_Components(std::move(components))
+  {
+    std::sort(m_Components.begin(), m_Components.end(), [](const ComponentInfo* a, const ComponentInfo* b) { return a->id < b->id; });
+
+    // 1. Rows per chunk (shrunk until the aligned columns fit, at least one row even for oversized components)
+    size_t rowBytes = sizeof(EntityID);
+    for (const ComponentInfo* component : m_Components) rowBytes += component->size;
+
+    auto layout = [&](size_t capacity) {
+      m_ColumnOffsets.clear();
+      size_t offset = capacity * sizeof(EntityID);
+      for (const ComponentInfo* component : m_Components) {
+        offset = (offset + component->alignment - 1) / component->alignment * component->alignment;
+        m_ColumnOffsets.push_back(offset);
+        offset += capacity * component->size;
+      }
+      return offset;
+    };
+
+    m_ChunkCapacity = std::max<size_t>(CHUNK_BYTES / rowBytes, 1);
+    while (m_ChunkCapacity > 1 && layout(m_ChunkCapacity) > CHUNK_BYTES) --m_ChunkCapacity;
+
+    // 2. Column offsets of the final capacity
+    m_ChunkBytes = std::max(layout(m_ChunkCapacity), CHUNK_BYTES);
+  }
+
+  Archetype::~Archetype() {
+    for (size_t row = 0; row < m_Count; ++row) {
+      for (size_t c = 0; c < m_Components.size(); ++c) {
+        m_Components[c]->destroy(At(c, row));
+      }
+    }
+  }
+
+  int Archetype::ColumnOf(ComponentTypeID id) const {
+    for (size_t c = 0; c < m_Components.size(); ++c) {
+      if (m_Components[c]->id == id) return (int)c;
+    }
+    return -1;
+  }
+
+  size_t Archetype::AllocateRow(EntityID entity) {
+    if (m_Chunks.empty() || m_Chunks.back().count == m_ChunkCapacity) {
+      Chunk chunk;
+      chunk.data.reset(static_cast<std::byte*>(::operator new(m_ChunkBytes, std::align_val_t(CHUNK_ALIGNMENT))));
+      m_Chunks.push_back(std::move(chunk));
+    }
+
+    const size_t row = m_Count++;
+    Chunk& chunk = m_Chunks.back();
+    reinterpret_cast<EntityID*>(chunk.data.get())[chunk.count++] = entity;
+    return row;
+  }
+
+  EntityID Archetype::RemoveRow(size_t row) {
+    const size_t last = m_Count - 1;
+    EntityID movedEntity = INVALID_ENTITY_ID;
+
+    for (size_t c = 0; c < m_Components.size(); ++c) {
+      m_Components[c]->destroy(At(c, row));
+    }
+
+    // Fill the hole with the last row
+    if (row != last) {
+      for (size_t c = 0; c < m_Components.size(); ++c) {
+        m_Components[c]->moveConstruct(At(c, row), At(c, last));
+        m_Components[c]->destroy(At(c, last));
+      }
+      movedEntity = Entities(last / m_ChunkCapacity)[last % m_ChunkCapacity];
+      Entities(row / m_ChunkCapacity)[row % m_ChunkCapacity] = movedEntity;
+    }
+
+    --m_Count;
+    if (--m_Chunks.back().count == 0) m_Chunks.pop_back();
+    return movedEntity;
+  }
+
+  ArchetypeStorage::Location& ArchetypeStorage::GetLocation(EntityID entity) {
+    const EntityID index = GetEntityIndex(entity);
+    if (index >= m_Locations.size()) {
+      m_Locations.resize(index + 1);
+    }
+
+    Location& location = m_Locations[index];
+    if (location.archetype && location.entity != entity) {
+      throw std::invalid_argument("ArchetypeStorage: entity handle does not own its index (destroyed or stale)");
+    }
+    return location;
+  }
+
+  ArchetypeStorage::Location* ArchetypeStorage::FindLocation(EntityID entity) {
+    const EntityID index = GetEntityIndex(entity);
+    if (index >= m_Locations.size()) return nullptr;
+
+    Location& location = m_Locations[index];
+    if (!location.archetype || location.entity != entity) return nullptr;
+    return &location;
+  }
+
+  Archetype* ArchetypeStorage::FindArchetype(std::vector<const ComponentInfo*> components) {
+    std::sort(components.begin(), components.end(), [](const ComponentInfo* a, const ComponentInfo* b) { return a->id < b->id; });
+
+    std::vector<ComponentTypeID> signature;
+    for (const ComponentInfo* component : components) signature.push_back(component->id);
+
+    auto it = m_Signatures.find(signature);
+    if (it != m_Signatures.end()) return it->second;
+
+    m_Archetypes.push_back(std::make_unique<Archetype>(std::move(components)));
+    m_Signatures[signature] = m_Archetypes.back().get();
+    return m_Archetypes.back().get();
+  }
+
+  Archetype* ArchetypeStorage::FindAddTarget(Archetype* source, const ComponentInfo& info) {
+    if (!source) return FindArchetype({ &info });
+
+    auto edge = source->m_AddEdges.find(info.id);
+    if (edge != source->m_AddEdges.end()) return edge->second;
+
+    std::vector<const ComponentInfo*> components = source->GetComponents();
+    components.push_back(&info);
+
+    Archetype* target = FindArchetype(components);
+    source->m_AddEdges[info.id] = target;
+    target->m_RemoveEdges[info.id] = source;
+    return target;
+  }
+
+  Archetype* ArchetypeStorage::FindRemoveTarget(Archetype* source, ComponentTypeID id) {
+    auto edge = source->m_RemoveEdges.find(id);
+    if (edge != source->m_RemoveEdges.end()) return edge->second;
+
+    // Removing the last component leaves the entity out of every archetype
+    if (source->GetComponents().size() == 1) return nullptr;
+
+    std::vector<const ComponentInfo*> components;
+    for (const ComponentInfo* component : source->GetComponents()) {
+      if (component->id != id) components.push_back(component);
+    }
+
+    Archetype* target = FindArchetype(components);
+    source->m_RemoveEdges[id] = target;
+    target->m_AddEdges[id] = source;
+    return target;
+  }
+
+  size_t ArchetypeStorage::MoveEntity(EntityID entity, Archetype* target) {
+    Location& location = m_Locations[GetEntityIndex(entity)];
+    const size_t row = target->AllocateRow(entity);
+
+    if (location.archetype) {
+      Archetype* source = location.archetype;
+
+      // Shared columns move across, the rest stay behind and are destroyed with the old row
+      const auto& components = target->GetComponents();
+      for (size_t c = 0; c < components.size(); ++c) {
+        const int sourceColumn = source->ColumnOf(components[c]->id);
+        if (sourceColumn >= 0) components[c]->moveConstruct(target->At(c, row), source->At(sourceColumn, location.row));
+      }
+
+      const EntityID movedEntity = source->RemoveRow(location.row);
+      if (movedEntity != INVALID_ENTITY_ID) m_Locations[GetEntityIndex(movedEntity)].row = location.row;
+    }
+
+    location.archetype = target;
+    location.row = row;
+    location.entity = entity;
+    return row;
+  }
+
+  void ArchetypeStorage::RemoveEntity(EntityID entity) {
+    Location* location = FindLocation(entity);
+    if (!location) return;
+
+    const EntityID movedEntity = location->archetype->RemoveRow(location->row);
+    if (movedEntity != INVALID_ENTITY_ID) m_Locations[GetEntityIndex(movedEntity)].row = location->row;
+
+    location->archetype = nullptr;
+    location->entity = INVALID_ENTITY_ID;
+  }
+
+}
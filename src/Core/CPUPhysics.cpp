@@ -0,0 +1,1279 @@
+#include "Spade/Core/CPUPhysics.hpp"
+
+#include <cmath>
+#include <bit>
+#include <cstdint>
+#include <atomic>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+  #define SPADE_X86 1
+  #include <immintrin.h>
+  #if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+    #define SPADE_TARGET_AVX2
+  #else
+    #define SPADE_TARGET_AVX2 __attribute__((target("avx2,fma")))
+  #endif
+#endif
+
+namespace Spade {
+
+  namespace {
+
+    // Matches the constant used by the shaders
+    constexpr float PI = 3.14159f;
+
+    // Instances per task, large enough to amortize the queue, small enough to balance uneven cells
+    constexpr size_t GRAIN_SIZE = 1024;
+
+    // Neighbour ranges shorter than one AVX2 step stay scalar (the vector setup would cost more than it saves)
+    constexpr size_t AVX2_MIN_RANGE = 8;
+
+    constexpr unsigned int HASH_TABLE_SIZE = 1 << 21;
+    constexpr uint64_t EMPTY_SPARSE_KEY = UINT64_MAX;
+    constexpr unsigned int NO_PARENT = 0xFFFFFFFF;
+
+    bool CPUSupportsAVX2() {
+#if defined(SPADE_X86) && defined(_MSC_VER) && !defined(__clang__)
+      int registers[4];
+      __cpuid(registers, 1);
+      bool osxsave = (registers[2] & (1 << 27)) != 0;
+      bool fma = (registers[2] & (1 << 12)) != 0;
+      if (!osxsave || !fma || (_xgetbv(0) & 0x6) != 0x6) return false;
+
+      __cpuidex(registers, 7, 0);
+      return (registers[1] & (1 << 5)) != 0;
+#elif defined(SPADE_X86)
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+      return false;
+#endif
+    }
+
+    // Sorted particle arrays seen by the inner loops
+    struct SortedParticles {
+      const float* positionX;
+      const float* positionY;
+      const float* positionZ;
+      const float* velocityX;
+      const float* velocityY;
+      const float* velocityZ;
+      const float* mass;
+      const float* radius;
+      const float* fluidActive;
+      const float* pressure;
+      const float* neighborDensity;
+    };
+
+    // --- Scalar Kernels ---
+
+    float DensityRangeScalar(const SortedParticles& p, size_t i, const glm::vec3& myPos, size_t start, size_t end, float h2, float poly6) {
+      float density = 0.0f;
+
+      for (size_t k = start; k < end; ++k) {
+        if (k == i) continue;
+
+        float dx = myPos.x - p.positionX[k];
+        float dy = myPos.y - p.positionY[k];
+        float dz = myPos.z - p.positionZ[k];
+        float r2 = dx * dx + dy * dy + dz * dz;
+
+        if (r2 < h2) {
+          float diff = h2 - r2;
+          density += p.mass[k] * poly6 * diff * diff * diff;
+        }
+      }
+
+      return density;
+    }
+
+    void ForceRangeScalar(const SortedParticles& p, size_t i, const glm::vec3& myPos, const glm::vec3& myVel, size_t start, size_t end, float h, float spiky, float viscosityLaplacian,
+      float myPressure, float myViscosity, glm::vec3& pressureForce, glm::vec3& viscosityForce) {
+      float h2 = h * h;
+
+      for (size_t k = start; k < end; ++k) {
+        if (k == i || p.fluidActive[k] == 0.0f) continue;
+
+        glm::vec3 r = myPos - glm::vec3(p.positionX[k], p.positionY[k], p.positionZ[k]);
+        float r2 = glm::dot(r, r);
+        if (r2 >= h2) continue;
+
+        float dist = std::sqrt(r2);
+        if (dist <= 0.0f || dist >= h) continue;
+
+        float otherDensity = p.neighborDensity[k];
+        float diff = h - dist;
+
+        // Pressure (Spiky Gradient), Viscosity (Laplacian)
+        float pTerm = (myPressure + p.pressure[k]) / (2.0f * otherDensity);
+        pressureForce -= p.mass[k] * pTerm * (spiky * diff * diff / dist) * r;
+
+        glm::vec3 velDiff = glm::vec3(p.velocityX[k], p.velocityY[k], p.velocityZ[k]) - myVel;
+        viscosityForce += myViscosity * p.mass[k] * (velDiff / otherDensity) * (viscosityLaplacian * diff);
+      }
+    }
+
+    // Candidate contacts of particle i in [start, end), bit n set for k = start + n (32 at a time)
+    unsigned int ContactMaskScalar(const SortedParticles& p, size_t i, const glm::vec3& myPos, size_t start, size_t end, float myRadius, bool myFluid) {
+      unsigned int mask = 0;
+
+      for (size_t k = start; k < end; ++k) {
+        if (k == i || (myFluid && p.fluidActive[k] != 0.0f)) continue;
+
+        float dx = myPos.x - p.positionX[k];
+        float dy = myPos.y - p.positionY[k];
+        float dz = myPos.z - p.positionZ[k];
+        float distSq = dx * dx + dy * dy + dz * dz;
+        float minDist = myRadius + p.radius[k];
+
+        if (distSq < minDist * minDist && distSq > 0.000001f) mask |= 1u << (k - start);
+      }
+
+      return mask;
+    }
+
+#if defined(SPADE_X86)
+
+    // --- AVX2 Kernels (8 neighbours per step, the tail falls back to scalar) ---
+    // Every kernel clears the upper halves before returning to SSE code: GCC and Clang only do it themselves
+    // when the whole file is built for AVX, and a dirty upper state slows every later SSE instruction.
+
+    SPADE_TARGET_AVX2 float HorizontalSum(__m256 value) {
+      __m128 sum = _mm_add_ps(_mm256_castps256_ps128(value), _mm256_extractf128_ps(value, 1));
+      sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+      sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 0x55));
+      return _mm_cvtss_f32(sum);
+    }
+
+    // Lanes whose index equals i are cleared
+    SPADE_TARGET_AVX2 __m256 NotSelf(size_t i, size_t k) {
+      __m256i lanes = _mm256_add_epi32(_mm256_set1_epi32((int)k), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+      __m256i self = _mm256_cmpeq_epi32(lanes, _mm256_set1_epi32((int)i));
+      return _mm256_castsi256_ps(_mm256_xor_si256(self, _mm256_set1_epi32(-1)));
+    }
+
+    SPADE_TARGET_AVX2 float DensityRangeAVX2(const SortedParticles& p, size_t i, const glm::vec3& myPos, size_t start, size_t end, float h2, float poly6) {
+      __m256 px = _mm256_set1_ps(myPos.x);
+      __m256 py = _mm256_set1_ps(myPos.y);
+      __m256 pz = _mm256_set1_ps(myPos.z);
+      __m256 vh2 = _mm256_set1_ps(h2);
+      __m256 vPoly6 = _mm256_set1_ps(poly6);
+      __m256 sum = _mm256_setzero_ps();
+
+      size_t k = start;
+      for (; k + 8 <= end; k += 8) {
+        __m256 dx = _mm256_sub_ps(px, _mm256_loadu_ps(p.positionX + k));
+        __m256 dy = _mm256_sub_ps(py, _mm256_loadu_ps(p.positionY + k));
+        __m256 dz = _mm256_sub_ps(pz, _mm256_loadu_ps(p.positionZ + k));
+        __m256 r2 = _mm256_fmadd_ps(dz, dz, _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dx, dx)));
+
+        __m256 mask = _mm256_and_ps(_mm256_cmp_ps(r2, vh2, _CMP_LT_OQ), NotSelf(i, k));
+
+        __m256 diff = _mm256_sub_ps(vh2, r2);
+        __m256 weight = _mm256_mul_ps(_mm256_mul_ps(vPoly6, diff), _mm256_mul_ps(diff, diff));
+        sum = _mm256_add_ps(sum, _mm256_and_ps(mask, _mm256_mul_ps(_mm256_loadu_ps(p.mass + k), weight)));
+      }
+
+      float density = HorizontalSum(sum);
+      _mm256_zeroupper();
+
+      return density + DensityRangeScalar(p, i, myPos, k, end, h2, poly6);
+    }
+
+    SPADE_TARGET_AVX2 void ForceRangeAVX2(const SortedParticles& p, size_t i, const glm::vec3& myPos, const glm::vec3& myVel, size_t start, size_t end, float h, float spiky, float viscosityLaplacian,
+      float myPressure, float myViscosity, glm::vec3& pressureForce, glm::vec3& viscosityForce) {
+      __m256 px = _mm256_set1_ps(myPos.x);
+      __m256 py = _mm256_set1_ps(myPos.y);
+      __m256 pz = _mm256_set1_ps(myPos.z);
+      __m256 vx = _mm256_set1_ps(myVel.x);
+      __m256 vy = _mm256_set1_ps(myVel.y);
+      __m256 vz = _mm256_set1_ps(myVel.z);
+      __m256 vh = _mm256_set1_ps(h);
+      __m256 vh2 = _mm256_set1_ps(h * h);
+      __m256 vSpiky = _mm256_set1_ps(spiky);
+      __m256 vLaplacian = _mm256_set1_ps(viscosityLaplacian * myViscosity);
+      __m256 vPressure = _mm256_set1_ps(myPressure);
+      __m256 half = _mm256_set1_ps(0.5f);
+      __m256 zero = _mm256_setzero_ps();
+
+      __m256 pfx = zero, pfy = zero, pfz = zero;
+      __m256 vfx = zero, vfy = zero, vfz = zero;
+
+      size_t k = start;
+      for (; k + 8 <= end; k += 8) {
+        __m256 dx = _mm256_sub_ps(px, _mm256_loadu_ps(p.positionX + k));
+        __m256 dy = _mm256_sub_ps(py, _mm256_loadu_ps(p.positionY + k));
+        __m256 dz = _mm256_sub_ps(pz, _mm256_loadu_ps(p.positionZ + k));
+        __m256 r2 = _mm256_fmadd_ps(dz, dz, _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dx, dx)));
+        __m256 dist = _mm256_sqrt_ps(r2);
+
+        __m256 mask = _mm256_and_ps(_mm256_cmp_ps(r2, vh2, _CMP_LT_OQ), NotSelf(i, k));
+        mask = _mm256_and_ps(mask, _mm256_cmp_ps(_mm256_loadu_ps(p.fluidActive + k), zero, _CMP_NEQ_OQ));
+        mask = _mm256_and_ps(mask, _mm256_cmp_ps(dist, zero, _CMP_GT_OQ));
+        mask = _mm256_and_ps(mask, _mm256_cmp_ps(dist, vh, _CMP_LT_OQ));
+        if (_mm256_movemask_ps(mask) == 0) continue;
+
+        __m256 mass = _mm256_loadu_ps(p.mass + k);
+        __m256 otherDensity = _mm256_loadu_ps(p.neighborDensity + k);
+        __m256 diff = _mm256_sub_ps(vh, dist);
+
+        // -mass * (pi + pj) / (2 * rho_j) * spiky * diff^2 / dist  (times r)
+        __m256 pTerm = _mm256_div_ps(_mm256_mul_ps(_mm256_add_ps(vPressure, _mm256_loadu_ps(p.pressure + k)), half), otherDensity);
+        __m256 gradient = _mm256_div_ps(_mm256_mul_ps(vSpiky, _mm256_mul_ps(diff, diff)), dist);
+        __m256 pressureScale = _mm256_and_ps(mask, _mm256_mul_ps(_mm256_mul_ps(mass, pTerm), gradient));
+        pfx = _mm256_fnmadd_ps(pressureScale, dx, pfx);
+        pfy = _mm256_fnmadd_ps(pressureScale, dy, pfy);
+        pfz = _mm256_fnmadd_ps(pressureScale, dz, pfz);
+
+        // viscosity * mass / rho_j * laplacian * (v_j - v_i)
+        __m256 viscosityScale = _mm256_and_ps(mask, _mm256_div_ps(_mm256_mul_ps(_mm256_mul_ps(mass, vLaplacian), diff), otherDensity));
+        vfx = _mm256_fmadd_ps(viscosityScale, _mm256_sub_ps(_mm256_loadu_ps(p.velocityX + k), vx), vfx);
+        vfy = _mm256_fmadd_ps(viscosityScale, _mm256_sub_ps(_mm256_loadu_ps(p.velocityY + k), vy), vfy);
+        vfz = _mm256_fmadd_ps(viscosityScale, _mm256_sub_ps(_mm256_loadu_ps(p.velocityZ + k), vz), vfz);
+      }
+
+      pressureForce += glm::vec3(HorizontalSum(pfx), HorizontalSum(pfy), HorizontalSum(pfz));
+      viscosityForce += glm::vec3(HorizontalSum(vfx), HorizontalSum(vfy), HorizontalSum(vfz));
+      _mm256_zeroupper();
+
+      ForceRangeScalar(p, i, myPos, myVel, k, end, h, spiky, viscosityLaplacian, myPressure, myViscosity, pressureForce, viscosityForce);
+    }
+
+    SPADE_TARGET_AVX2 unsigned int ContactMaskAVX2(const SortedParticles& p, size_t i, const glm::vec3& myPos, size_t start, size_t end, float myRadius, bool myFluid) {
+      __m256 px = _mm256_set1_ps(myPos.x);
+      __m256 py = _mm256_set1_ps(myPos.y);
+      __m256 pz = _mm256_set1_ps(myPos.z);
+      __m256 vRadius = _mm256_set1_ps(myRadius);
+      __m256 minDistSq = _mm256_set1_ps(0.000001f);
+      __m256 zero = _mm256_setzero_ps();
+
+      unsigned int mask = 0;
+
+      size_t k = start;
+      for (; k + 8 <= end; k += 8) {
+        __m256 dx = _mm256_sub_ps(px, _mm256_loadu_ps(p.positionX + k));
+        __m256 dy = _mm256_sub_ps(py, _mm256_loadu_ps(p.positionY + k));
+        __m256 dz = _mm256_sub_ps(pz, _mm256_loadu_ps(p.positionZ + k));
+        __m256 distSq = _mm256_fmadd_ps(dz, dz, _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dx, dx)));
+        __m256 minDist = _mm256_add_ps(vRadius, _mm256_loadu_ps(p.radius + k));
+
+        __m256 hit = _mm256_and_ps(_mm256_cmp_ps(distSq, _mm256_mul_ps(minDist, minDist), _CMP_LT_OQ), _mm256_cmp_ps(distSq, minDistSq, _CMP_GT_OQ));
+        hit = _mm256_and_ps(hit, NotSelf(i, k));
+
+        // Fluid against fluid is left to SPH
+        if (myFluid) hit = _mm256_andnot_ps(_mm256_cmp_ps(_mm256_loadu_ps(p.fluidActive + k), zero, _CMP_NEQ_OQ), hit);
+
+        mask |= (unsigned int)_mm256_movemask_ps(hit) << (k - start);
+      }
+
+      _mm256_zeroupper();
+
+      return mask | (ContactMaskScalar(p, i, myPos, k, end, myRadius, myFluid) << (k - start));
+    }
+
+#endif
+
+    // Wall clamp of one axis (shader order: position first, then reflect the velocity)
+    void ClampToWall(float& position, float& velocity, float limit, float bounciness) {
+      if (position < -limit) {
+        position = -limit;
+        if (velocity < 0) velocity *= -bounciness;
+      } else if (position > limit) {
+        position = limit;
+        if (velocity > 0) velocity *= -bounciness;
+      }
+    }
+
+    // Sphere-sphere contact, accumulated exactly like GridCollision.comp
+    void ResolveContact(const glm::vec3& myPos, const glm::vec3& myVel, float myMass, const Bound& myBound,
+      const glm::vec3& otherPos, const glm::vec3& otherVel, float otherMass, const Bound& otherBound,
+      glm::vec3& totalCorrection, float& numCorrections, glm::vec3& totalVelocityChange) {
+      glm::vec3 dir = myPos - otherPos;
+      float distSq = glm::dot(dir, dir);
+      float minDist = (myBound.size + otherBound.size) * 0.5f;
+
+      if (distSq >= minDist * minDist || distSq <= 0.000001f) return;
+
+      float dist = std::sqrt(distSq);
+      glm::vec3 normal = dir / dist;
+
+      // Position Correction (Accumulate)
+      totalCorrection += normal * (minDist - dist);
+      numCorrections += 1.0f;
+
+      // Velocity Reflection
+      glm::vec3 relVel = myVel - otherVel;
+      float velAlongNormal = glm::dot(relVel, normal);
+      if (velAlongNormal >= 0) return;
+
+      float restitution = std::min(myBound.bounciness, otherBound.bounciness);
+      if (std::abs(velAlongNormal) < 0.5f) restitution = 0.0f; // Resting threshold
+
+      float j = -(1.0f + restitution) * velAlongNormal;
+      j /= (1.0f / myMass + 1.0f / otherMass);
+      totalVelocityChange += (j * normal) / myMass;
+
+      // Friction (Simple)
+      glm::vec3 tangent = relVel - (velAlongNormal * normal);
+      float tangentLen = glm::length(tangent);
+      if (tangentLen > 0.0001f) {
+        tangent /= tangentLen;
+        float friction = std::sqrt(myBound.friction * otherBound.friction);
+        float jTangent = -glm::dot(relVel, tangent);
+        jTangent /= (1.0f / myMass + 1.0f / otherMass);
+
+        glm::vec3 frictionImpulse = (std::abs(jTangent) < j * friction) ? jTangent * tangent : -j * friction * tangent;
+        totalVelocityChange += frictionImpulse / myMass;
+      }
+    }
+
+    unsigned int ExpandBits(unsigned int v) {
+      v = (v * 0x00010001u) & 0xFF0000FFu;
+      v = (v * 0x00000101u) & 0x0F00F00Fu;
+      v = (v * 0x00000011u) & 0xC30C30C3u;
+      v = (v * 0x00000005u) & 0x49249249u;
+      return v;
+    }
+
+  }
+
+  CPUPhysics::CPUPhysics(unsigned int threadCount)
+    : m_ThreadPool(threadCount), m_UseAVX2(CPUSupportsAVX2())
+  { }
+
+  void CPUPhysics::SetUseAVX2(bool useAVX2) {
+    m_UseAVX2 = useAVX2 && CPUSupportsAVX2();
+  }
+
+  void CPUPhysics::EnableMotion(std::vector<Transform>& transforms, std::vector<Motion>& motions, float deltaTime) {
+    m_ThreadPool.ParallelFor(0, motions.size(), GRAIN_SIZE * 16, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        motions[i].velocity += motions[i].acceleration * deltaTime;
+        transforms[i].position += motions[i].velocity * deltaTime;
+
+        // Reset acceleration (forces) for next frame
+        motions[i].acceleration = glm::vec3(0.0f);
+      }
+    });
+  }
+
+  void CPUPhysics::EnableGravity(std::vector<Motion>& motions, float globalGravity) {
+    m_ThreadPool.ParallelFor(0, motions.size(), GRAIN_SIZE * 16, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        motions[i].acceleration.y -= globalGravity;
+      }
+    });
+  }
+
+  glm::ivec3 CPUPhysics::GetGridCell(const glm::vec3& position) const {
+    glm::vec3 offsetPos = position + glm::vec3(m_GridBounds);
+    glm::ivec3 cell = glm::ivec3(glm::floor(offsetPos / m_GridCellSize));
+    if (m_GridMode == SparseGrid) return cell; // No grid box
+    return glm::clamp(cell, glm::ivec3(0), glm::ivec3(m_GridDim - 1));
+  }
+
+  uint64_t CPUPhysics::PackSparseCell(const glm::ivec3& cell) {
+    // 21 bits per axis, same packing as the shaders (wraps every 2^21 cells)
+    const uint64_t x = (uint32_t)cell.x & 0x1FFFFFu;
+    const uint64_t y = (uint32_t)cell.y & 0x1FFFFFu;
+    const uint64_t z = (uint32_t)cell.z & 0x1FFFFFu;
+    return x | (y << 21) | (z << 42);
+  }
+
+  unsigned int CPUPhysics::GetSparseHash(uint64_t key) const {
+    const unsigned int p1 = 73856093u;
+    const unsigned int p2 = 19349663u;
+
+    return (((unsigned int)key * p1) ^ ((unsigned int)(key >> 32) * p2)) & (m_TotalCells - 1);
+  }
+
+  bool CPUPhysics::GetCellKey(const glm::ivec3& cell, unsigned int& key) const {
+    if (m_GridMode == DenseGrid) {
+      if (glm::any(glm::lessThan(cell, glm::ivec3(0))) || glm::any(glm::greaterThanEqual(cell, glm::ivec3(m_GridDim)))) return false;
+      key = (unsigned int)(cell.x + m_GridDim * (cell.y + m_GridDim * cell.z));
+      return true;
+    }
+
+    if (m_GridMode == SparseGrid) {
+      // Linear probing, stops at the first empty slot
+      const uint64_t packed = PackSparseCell(cell);
+      key = GetSparseHash(packed);
+      for (unsigned int probe = 0; probe < m_TotalCells; ++probe) {
+        if (m_SparseKeys[key] == EMPTY_SPARSE_KEY) return false;
+        if (m_SparseKeys[key] == packed) return true;
+        key = (key + 1) & (m_TotalCells - 1);
+      }
+      return false;
+    }
+
+    const unsigned int p1 = 73856093u;
+    const unsigned int p2 = 19349663u;
+    const unsigned int p3 = 83492791u;
+
+    key = (((unsigned int)cell.x * p1) ^ ((unsigned int)cell.y * p2) ^ ((unsigned int)cell.z * p3)) % m_TotalCells;
+    return true;
+  }
+
+  unsigned int CPUPhysics::InsertSparseCell(const glm::ivec3& cell) {
+    const uint64_t packed = PackSparseCell(cell);
+    unsigned int slot = GetSparseHash(packed);
+
+    // The table holds at least twice as many slots as instances, so probing always ends
+    while (true) {
+      uint64_t expected = EMPTY_SPARSE_KEY;
+      std::atomic_ref<uint64_t> stored(m_SparseKeys[slot]);
+      if (stored.compare_exchange_strong(expected, packed, std::memory_order_relaxed) || expected == packed) return slot;
+      slot = (slot + 1) & (m_TotalCells - 1);
+    }
+  }
+
+  template <typename F>
+  void CPUPhysics::ForEachNeighborRange(const glm::vec3& position, F&& rangeFunction) const {
+    glm::ivec3 cell = GetGridCell(position);
+
+    // Ranges that continue each other (x neighbours in a dense grid) are joined into one longer range
+    size_t rangeStart = 0;
+    size_t rangeEnd = 0;
+
+    for (int z = -1; z <= 1; ++z) {
+      for (int y = -1; y <= 1; ++y) {
+        for (int x = -1; x <= 1; ++x) {
+          unsigned int key;
+          if (!GetCellKey(cell + glm::ivec3(x, y, z), key)) continue;
+
+          int start = m_CellStart[key];
+          if (start == -1) continue;
+
+          if ((size_t)start != rangeEnd || rangeStart == rangeEnd) {
+            if (rangeStart != rangeEnd) rangeFunction(rangeStart, rangeEnd);
+            rangeStart = (size_t)start;
+          }
+          rangeEnd = (size_t)m_CellEnd[key];
+        }
+      }
+    }
+
+    if (rangeStart != rangeEnd) rangeFunction(rangeStart, rangeEnd);
+  }
+
+  template <typename F>
+  bool CPUPhysics::ForEachInstanceInCells(const glm::ivec3& low, const glm::ivec3& high, F&& instanceFunction) const {
+    for (int z = low.z; z <= high.z; ++z) {
+      for (int y = low.y; y <= high.y; ++y) {
+        for (int x = low.x; x <= high.x; ++x) {
+          const glm::ivec3 cell(x, y, z);
+
+          unsigned int key;
+          if (!GetCellKey(cell, key)) continue;
+
+          int start = m_CellStart[key];
+          if (start == -1) continue;
+
+          for (size_t k = (size_t)start; k < (size_t)m_CellEnd[key]; ++k) {
+            // A hashed bucket holds every cell aliasing to it, only the visited cell's own instances count
+            const glm::vec3 position(m_PositionX[k], m_PositionY[k], m_PositionZ[k]);
+            if (m_GridMode == HashedGrid && GetGridCell(position) != cell) continue;
+
+            if (!instanceFunction(k)) return false;
+          }
+        }
+      }
+    }
+
+    return true;
+  }
+
+  void CPUPhysics::ExclusiveScan(std::vector<int>& values) {
+    size_t blockSize = GRAIN_SIZE * 64;
+    size_t blocks = (values.size() + blockSize - 1) / blockSize;
+    std::vector<int> blockSums(blocks, 0);
+
+    // 1. Block Totals
+    m_ThreadPool.ParallelFor(0, blocks, 1, [&](size_t begin, size_t end) {
+      for (size_t b = begin; b < end; ++b) {
+        size_t last = std::min(values.size(), (b + 1) * blockSize);
+        int sum = 0;
+        for (size_t i = b * blockSize; i < last; ++i) sum += values[i];
+        blockSums[b] = sum;
+      }
+    });
+
+    // 2. Scan Totals
+    int running = 0;
+    for (int& sum : blockSums) {
+      int blockSum = sum;
+      sum = running;
+      running += blockSum;
+    }
+
+    // 3. Scan Blocks from their Offset
+    m_ThreadPool.ParallelFor(0, blocks, 1, [&](size_t begin, size_t end) {
+      for (size_t b = begin; b < end; ++b) {
+        size_t last = std::min(values.size(), (b + 1) * blockSize);
+        int sum = blockSums[b];
+        for (size_t i = b * blockSize; i < last; ++i) {
+          int value = values[i];
+          values[i] = sum;
+          sum += value;
+        }
+      }
+    });
+  }
+
+  void CPUPhysics::BuildGrid(const std::vector<Transform>& transforms, const std::vector<Motion>& motions,
+    float globalBounds, float cellSize, GridMode gridMode) {
+    size_t numInstances = transforms.size();
+
+    m_GridMode = gridMode;
+    m_GridBounds = globalBounds;
+    m_GridCellSize = cellSize;
+    m_GridDim = std::max(1, (int)std::floor((globalBounds * 2.0f) / cellSize));
+    m_TotalCells = (gridMode == DenseGrid) ? (size_t)m_GridDim * m_GridDim * m_GridDim : HASH_TABLE_SIZE;
+
+    // Sparse Table (a power of two above twice the instance count, which bounds the occupied cells)
+    if (gridMode == SparseGrid) {
+      m_TotalCells = std::bit_ceil(std::max<unsigned int>((unsigned int)numInstances * 2, 64));
+      m_SparseKeys.assign(m_TotalCells, EMPTY_SPARSE_KEY);
+    }
+
+    m_CellKeys.resize(numInstances);
+    m_SortedKeys.resize(numInstances);
+    m_SortedInstances.resize(numInstances);
+    m_CellStart.assign(m_TotalCells, 0);
+    m_CellEnd.resize(m_TotalCells);
+
+    // 1. Cell Keys and Counts (counts live in CellStart until the scan)
+    m_ThreadPool.ParallelFor(0, numInstances, GRAIN_SIZE * 16, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        // The own cell is clamped into the grid (or inserted into the sparse table), so it always has a key
+        unsigned int key = 0;
+        if (gridMode == SparseGrid) {
+          key = InsertSparseCell(GetGridCell(transforms[i].position));
+        } else {
+          (void)GetCellKey(GetGridCell(transforms[i].position), key);
+        }
+        m_CellKeys[i] = key;
+        std::atomic_ref<int>(m_CellStart[key]).fetch_add(1, std::memory_order_relaxed);
+      }
+    });
+
+    // 2. Cell Starts
+    ExclusiveScan(m_CellStart);
+    m_CellEnd = m_CellStart;
+
+    // 3. Place (CellEnd is the cursor and ends as the range end)
+    m_ThreadPool.ParallelFor(0, numInstances, GRAIN_SIZE * 16, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        int slot = std::atomic_ref<int>(m_CellEnd[m_CellKeys[i]]).fetch_add(1, std::memory_order_relaxed);
+        m_SortedInstances[slot] = (unsigned int)i;
+        m_SortedKeys[slot] = m_CellKeys[i];
+      }
+    });
+
+    // 4. Restore Instance Order inside each Cell (placement order depends on the threads)
+    m_ThreadPool.ParallelFor(0, numInstances, GRAIN_SIZE * 16, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        if (i > 0 && m_SortedKeys[i - 1] == m_SortedKeys[i]) continue;
+        int cellEnd = m_CellEnd[m_SortedKeys[i]];
+        std::sort(m_SortedInstances.begin() + i, m_SortedInstances.begin() + cellEnd);
+      }
+    });
+
+    // 5. Empty Cells start at -1 (as in the shaders)
+    m_ThreadPool.ParallelFor(0, m_TotalCells, GRAIN_SIZE * 64, [&](size_t begin, size_t end) {
+      for (size_t c = begin; c < end; ++c) {
+        if (m_CellStart[c] == m_CellEnd[c]) m_CellStart[c] = -1;
+      }
+    });
+
+    // 6. Sorted Snapshot
+    for (auto* array : { &m_PositionX, &m_PositionY, &m_PositionZ, &m_VelocityX, &m_VelocityY, &m_VelocityZ, &m_Mass, &m_Density }) {
+      array->resize(numInstances);
+    }
+
+    m_ThreadPool.ParallelFor(0, numInstances, GRAIN_SIZE * 16, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        const Transform& transform = transforms[m_SortedInstances[i]];
+        const Motion& motion = motions[m_SortedInstances[i]];
+        m_PositionX[i] = transform.position.x;
+        m_PositionY[i] = transform.position.y;
+        m_PositionZ[i] = transform.position.z;
+        m_VelocityX[i] = motion.velocity.x;
+        m_VelocityY[i] = motion.velocity.y;
+        m_VelocityZ[i] = motion.velocity.z;
+        m_Mass[i] = motion.mass;
+        m_Density[i] = motion.density;
+      }
+    });
+  }
+
+  void CPUPhysics::EnableSPHFluid(std::vector<Motion>& motions, const std::vector<unsigned int>& instanceToEntityIndex,
+    const std::vector<FluidMaterial>& entityFluidMaterials) {
+    size_t numInstances = m_SortedInstances.size();
+
+    float h = m_GridCellSize; // Smoothing Radius
+    float h2 = h * h;
+    float poly6 = 315.0f / (64.0f * PI * std::pow(h, 9.0f));
+    float spiky = -45.0f / (PI * std::pow(h, 6.0f));
+    float viscosityLaplacian = 45.0f / (PI * std::pow(h, 6.0f));
+
+    for (auto* array : { &m_Radius, &m_FluidActive, &m_Pressure, &m_NeighborDensity }) {
+      array->resize(numInstances);
+    }
+
+    SortedParticles particles = { m_PositionX.data(), m_PositionY.data(), m_PositionZ.data(),
+      m_VelocityX.data(), m_VelocityY.data(), m_VelocityZ.data(), m_Mass.data(),
+      m_Radius.data(), m_FluidActive.data(), m_Pressure.data(), m_NeighborDensity.data() };
+
+    m_ThreadPool.ParallelFor(0, numInstances, GRAIN_SIZE, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        m_FluidActive[i] = entityFluidMaterials[instanceToEntityIndex[m_SortedInstances[i]]].active == 1 ? 1.0f : 0.0f;
+      }
+    });
+
+    // 1. Density (Poly6)
+    m_ThreadPool.ParallelFor(0, numInstances, GRAIN_SIZE, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        if (m_FluidActive[i] == 0.0f) continue;
+
+        const FluidMaterial& myMat = entityFluidMaterials[instanceToEntityIndex[m_SortedInstances[i]]];
+        glm::vec3 myPos = { m_PositionX[i], m_PositionY[i], m_PositionZ[i] };
+
+        // Self-Density
+        float density = m_Mass[i] * poly6 * h2 * h2 * h2;
+
+        ForEachNeighborRange(myPos, [&](size_t start, size_t end) {
+#if defined(SPADE_X86)
+          if (m_UseAVX2 && end - start >= AVX2_MIN_RANGE) {
+            density += DensityRangeAVX2(particles, i, myPos, start, end, h2, poly6);
+            return;
+          }
+#endif
+          density += DensityRangeScalar(particles, i, myPos, start, end, h2, poly6);
+        });
+
+        // Avoid Zero Density (Vacuum)
+        if (density < myMat.restDensity) density = myMat.restDensity;
+
+        m_Density[i] = density;
+        motions[m_SortedInstances[i]].density = density;
+      }
+    });
+
+    // 2. Pressure as seen by Neighbours
+    m_ThreadPool.ParallelFor(0, numInstances, GRAIN_SIZE * 16, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        const FluidMaterial& material = entityFluidMaterials[instanceToEntityIndex[m_SortedInstances[i]]];
+        m_NeighborDensity[i] = std::max(1.0f, m_Density[i]);
+        m_Pressure[i] = std::max(0.0f, material.stiffness * (m_NeighborDensity[i] - material.restDensity));
+      }
+    });
+
+    // 3. Forces (Pressure + Viscosity)
+    m_ThreadPool.ParallelFor(0, numInstances, GRAIN_SIZE, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        float myDensity = m_Density[i];
+        if (myDensity <= 0.0001f || m_FluidActive[i] == 0.0f) continue;
+
+        const FluidMaterial& myMat = entityFluidMaterials[instanceToEntityIndex[m_SortedInstances[i]]];
+        float pressure = std::max(0.0f, myMat.stiffness * (myDensity - myMat.restDensity));
+
+        glm::vec3 myPos = { m_PositionX[i], m_PositionY[i], m_PositionZ[i] };
+        glm::vec3 myVel = { m_VelocityX[i], m_VelocityY[i], m_VelocityZ[i] };
+        glm::vec3 pressureForce(0.0f);
+        glm::vec3 viscosityForce(0.0f);
+
+        ForEachNeighborRange(myPos, [&](size_t start, size_t end) {
+#if defined(SPADE_X86)
+          if (m_UseAVX2 && end - start >= AVX2_MIN_RANGE) {
+            ForceRangeAVX2(particles, i, myPos, myVel, start, end, h, spiky, viscosityLaplacian, pressure, myMat.viscosity, pressureForce, viscosityForce);
+            return;
+          }
+#endif
+          ForceRangeScalar(particles, i, myPos, myVel, start, end, h, spiky, viscosityLaplacian, pressure, myMat.viscosity, pressureForce, viscosityForce);
+        });
+
+        if (myDensity > 0.001f) {
+          motions[m_SortedInstances[i]].acceleration += (pressureForce + viscosityForce) / myDensity;
+        }
+      }
+    });
+  }
+
+  void CPUPhysics::EnableGridCollision(std::vector<Transform>& transforms, std::vector<Motion>& motions,
+    const std::vector<unsigned int>& instanceToEntityIndex, const std::vector<Bound>& entityBounds,
+    const std::vector<FluidMaterial>& entityFluidMaterials) {
+    size_t numInstances = m_SortedInstances.size();
+    float globalBounds = m_GridBounds;
+
+    m_Radius.resize(numInstances);
+    m_FluidActive.resize(numInstances);
+
+    SortedParticles particles = { m_PositionX.data(), m_PositionY.data(), m_PositionZ.data(),
+      m_VelocityX.data(), m_VelocityY.data(), m_VelocityZ.data(), m_Mass.data(),
+      m_Radius.data(), m_FluidActive.data(), nullptr, nullptr };
+
+    m_ThreadPool.ParallelFor(0, numInstances, GRAIN_SIZE * 16, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        unsigned int entity = instanceToEntityIndex[m_SortedInstances[i]];
+        m_Radius[i] = entityBounds[entity].size * 0.5f;
+        m_FluidActive[i] = entityFluidMaterials[entity].active == 1 ? 1.0f : 0.0f;
+      }
+    });
+
+    m_ThreadPool.ParallelFor(0, numInstances, GRAIN_SIZE, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        unsigned int instance = m_SortedInstances[i];
+        const Bound& myBound = entityBounds[instanceToEntityIndex[instance]];
+        if (myBound.active == 0) continue;
+
+        glm::vec3 myPos = { m_PositionX[i], m_PositionY[i], m_PositionZ[i] };
+        glm::vec3 myVel = { m_VelocityX[i], m_VelocityY[i], m_VelocityZ[i] };
+        float myMass = m_Mass[i];
+        float myRadius = m_Radius[i];
+
+        // World Boundary Collision (Box, a sparse grid has none)
+        const bool hasWalls = (m_GridMode != SparseGrid);
+        float limit = globalBounds - myRadius;
+        if (hasWalls) {
+          ClampToWall(myPos.x, myVel.x, limit, myBound.bounciness);
+          ClampToWall(myPos.y, myVel.y, limit, myBound.bounciness);
+          ClampToWall(myPos.z, myVel.z, limit, myBound.bounciness);
+        }
+
+        glm::vec3 totalCorrection(0.0f);
+        float numCorrections = 0.0f;
+        glm::vec3 totalVelocityChange(0.0f);
+
+        // Contacts are tested from the wall-clamped position, like the shader
+        ForEachNeighborRange(myPos, [&](size_t start, size_t end) {
+          for (size_t chunk = start; chunk < end; chunk += 32) {
+            size_t chunkEnd = std::min(end, chunk + 32);
+            unsigned int contacts;
+#if defined(SPADE_X86)
+            if (m_UseAVX2 && chunkEnd - chunk >= AVX2_MIN_RANGE) {
+              contacts = ContactMaskAVX2(particles, i, myPos, chunk, chunkEnd, myRadius, m_FluidActive[i] != 0.0f);
+            } else
+#endif
+            contacts = ContactMaskScalar(particles, i, myPos, chunk, chunkEnd, myRadius, m_FluidActive[i] != 0.0f);
+
+            while (contacts) {
+              size_t k = chunk + std::countr_zero(contacts);
+              contacts &= contacts - 1;
+
+              const Bound& otherBound = entityBounds[instanceToEntityIndex[m_SortedInstances[k]]];
+              ResolveContact(myPos, myVel, myMass, myBound,
+                { m_PositionX[k], m_PositionY[k], m_PositionZ[k] }, { m_VelocityX[k], m_VelocityY[k], m_VelocityZ[k] }, m_Mass[k], otherBound,
+                totalCorrection, numCorrections, totalVelocityChange);
+            }
+          }
+        });
+
+        // Apply Accumulated Position Correction and Velocity Change (Averaged)
+        if (numCorrections > 0.0f) {
+          myPos += totalCorrection / numCorrections;
+          myVel += totalVelocityChange / numCorrections;
+        }
+
+        // Nan/Inf Safety & Hard Clamp to Global Bounds
+        if (std::isnan(myPos.x) || std::isinf(myPos.x)) myPos = glm::vec3(0.0f);
+        if (hasWalls) myPos = glm::clamp(myPos, glm::vec3(-limit), glm::vec3(limit));
+
+        transforms[instance].position = myPos;
+        motions[instance].velocity = myVel;
+      }
+    });
+  }
+
+  void CPUPhysics::SpatialQueries(const std::vector<SpatialQuery>& queries, SpatialQueryResults& results) {
+    constexpr unsigned int MAX_K = 16;
+
+    std::vector<std::vector<SpatialHit>> queryHits(queries.size());
+
+    m_ThreadPool.ParallelFor(0, queries.size(), 64, [&](size_t begin, size_t end) {
+      for (size_t q = begin; q < end; ++q) {
+        const SpatialQuery& query = queries[q];
+        std::vector<SpatialHit>& hits = queryHits[q];
+
+        const glm::vec3 origin = query.origin;
+        const float radiusSq = query.radius * query.radius;
+        const glm::ivec3 low = GetGridCell(origin - glm::vec3(query.radius));
+        const glm::ivec3 high = GetGridCell(origin + glm::vec3(query.radius));
+
+        auto distanceSq = [&](size_t k) {
+          const glm::vec3 offset = glm::vec3(m_PositionX[k], m_PositionY[k], m_PositionZ[k]) - origin;
+          return glm::dot(offset, offset);
+        };
+
+        // 1. Radius (grid order, up to maxResults)
+        if (query.type == QueryRadius) {
+          if (query.maxResults == 0) continue;
+
+          ForEachInstanceInCells(low, high, [&](size_t k) {
+            const float distSq = distanceSq(k);
+            if (distSq <= radiusSq) hits.push_back({ m_SortedInstances[k], std::sqrt(distSq) });
+            return hits.size() < query.maxResults;
+          });
+          continue;
+        }
+
+        // 2. K-Nearest (the k closest within the radius, nearest first)
+        if (query.type == QueryKNearest) {
+          const size_t k = std::min(query.maxResults, MAX_K);
+          if (k == 0) continue;
+
+          std::vector<std::pair<float, size_t>> best;
+          ForEachInstanceInCells(low, high, [&](size_t s) {
+            const float distSq = distanceSq(s);
+            if (distSq > radiusSq) return true;
+            if (best.size() == k && distSq >= best.back().first) return true;
+
+            if (best.size() == k) best.pop_back();
+            best.insert(std::upper_bound(best.begin(), best.end(), std::make_pair(distSq, s),
+              [](const auto& a, const auto& b) { return a.first < b.first; }), { distSq, s });
+            return true;
+          });
+
+          for (const auto& [distSq, s] : best) hits.push_back({ m_SortedInstances[s], std::sqrt(distSq) });
+          continue;
+        }
+
+        // 3. Raycast (neighbourhood of a sample every cell along the ray, clipped to the grid box if any, closest hit wins)
+        const glm::vec3 dir = glm::normalize(query.direction);
+        const glm::vec3 invDir = 1.0f / dir;
+        const glm::vec3 t0 = (glm::vec3(-m_GridBounds) - origin) * invDir;
+        const glm::vec3 t1 = (glm::vec3(m_GridBounds) - origin) * invDir;
+        const glm::vec3 tNear = glm::min(t0, t1);
+        const glm::vec3 tFar = glm::max(t0, t1);
+        const bool clipped = (m_GridMode != SparseGrid);
+        const float tEnter = clipped ? std::max({ tNear.x, tNear.y, tNear.z, 0.0f }) : 0.0f;
+        const float tExit = clipped ? std::min({ tFar.x, tFar.y, tFar.z, query.maxDistance }) : query.maxDistance;
+
+        float bestT = query.maxDistance;
+        size_t bestIndex = SIZE_MAX;
+
+        for (float t = tEnter; t <= tExit + m_GridCellSize && t <= bestT + 2.0f * m_GridCellSize; t += m_GridCellSize) {
+          const glm::ivec3 center = GetGridCell(origin + dir * std::min(t, tExit));
+
+          ForEachInstanceInCells(center - glm::ivec3(1), center + glm::ivec3(1), [&](size_t s) {
+            // Ray-Sphere (an origin inside the sphere hits at 0)
+            const glm::vec3 oc = origin - glm::vec3(m_PositionX[s], m_PositionY[s], m_PositionZ[s]);
+            const float b = glm::dot(oc, dir);
+            const float c = glm::dot(oc, oc) - radiusSq;
+            const float h = b * b - c;
+            if (h < 0.0f) return true;
+
+            const float hitT = c <= 0.0f ? 0.0f : -b - std::sqrt(h);
+            if (hitT >= 0.0f && hitT < bestT) {
+              bestT = hitT;
+              bestIndex = s;
+            }
+            return true;
+          });
+        }
+
+        if (bestIndex != SIZE_MAX) hits.push_back({ m_SortedInstances[bestIndex], bestT });
+      }
+    });
+
+    // Compacted in query order
+    results.ranges.resize(queries.size());
+    results.hits.clear();
+    for (size_t q = 0; q < queries.size(); ++q) {
+      results.ranges[q] = { (unsigned int)results.hits.size(), (unsigned int)queryHits[q].size() };
+      results.hits.insert(results.hits.end(), queryHits[q].begin(), queryHits[q].end());
+    }
+  }
+
+  void CPUPhysics::EnableBruteForceCollision(std::vector<Transform>& transforms, std::vector<Motion>& motions,
+    const std::vector<unsigned int>& instanceToEntityIndex, const std::vector<Bound>& entityBounds,
+    const std::vector<FluidMaterial>& entityFluidMaterials, float globalBounds) {
+    size_t numInstances = transforms.size();
+
+    // Snapshot in instance order (replaces any grid snapshot)
+    for (auto* array : { &m_PositionX, &m_PositionY, &m_PositionZ, &m_VelocityX, &m_VelocityY, &m_VelocityZ, &m_Mass, &m_Radius, &m_FluidActive }) {
+      array->resize(numInstances);
+    }
+    m_SortedInstances.clear();
+
+    m_ThreadPool.ParallelFor(0, numInstances, GRAIN_SIZE * 16, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        unsigned int entity = instanceToEntityIndex[i];
+        m_PositionX[i] = transforms[i].position.x;
+        m_PositionY[i] = transforms[i].position.y;
+        m_PositionZ[i] = transforms[i].position.z;
+        m_VelocityX[i] = motions[i].velocity.x;
+        m_VelocityY[i] = motions[i].velocity.y;
+        m_VelocityZ[i] = motions[i].velocity.z;
+        m_Mass[i] = motions[i].mass;
+        m_Radius[i] = entityBounds[entity].size * 0.5f;
+        m_FluidActive[i] = entityFluidMaterials[entity].active == 1 ? 1.0f : 0.0f;
+      }
+    });
+
+    SortedParticles particles = { m_PositionX.data(), m_PositionY.data(), m_PositionZ.data(),
+      m_VelocityX.data(), m_VelocityY.data(), m_VelocityZ.data(), m_Mass.data(),
+      m_Radius.data(), m_FluidActive.data(), nullptr, nullptr };
+
+    m_ThreadPool.ParallelFor(0, numInstances, 64, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        const Bound& myBound = entityBounds[instanceToEntityIndex[i]];
+        if (myBound.active == 0) continue;
+
+        glm::vec3 myPos = { m_PositionX[i], m_PositionY[i], m_PositionZ[i] };
+        glm::vec3 myVel = { m_VelocityX[i], m_VelocityY[i], m_VelocityZ[i] };
+        float myMass = m_Mass[i];
+        float myRadius = m_Radius[i];
+
+        // Global Bounds Check
+        float limit = globalBounds - myRadius;
+        ClampToWall(myPos.x, myVel.x, limit, myBound.bounciness);
+        ClampToWall(myPos.y, myVel.y, limit, myBound.bounciness);
+        ClampToWall(myPos.z, myVel.z, limit, myBound.bounciness);
+
+        glm::vec3 totalCorrection(0.0f);
+        float numCorrections = 0.0f;
+        glm::vec3 totalVelocityChange(0.0f);
+
+        // Check all other particles
+        for (size_t chunk = 0; chunk < numInstances; chunk += 32) {
+          size_t chunkEnd = std::min(numInstances, chunk + 32);
+          unsigned int contacts;
+#if defined(SPADE_X86)
+          if (m_UseAVX2 && chunkEnd - chunk >= AVX2_MIN_RANGE) {
+            contacts = ContactMaskAVX2(particles, i, myPos, chunk, chunkEnd, myRadius, m_FluidActive[i] != 0.0f);
+          } else
+#endif
+          contacts = ContactMaskScalar(particles, i, myPos, chunk, chunkEnd, myRadius, m_FluidActive[i] != 0.0f);
+
+          while (contacts) {
+            size_t k = chunk + std::countr_zero(contacts);
+            contacts &= contacts - 1;
+
+            ResolveContact(myPos, myVel, myMass, myBound,
+              { m_PositionX[k], m_PositionY[k], m_PositionZ[k] }, { m_VelocityX[k], m_VelocityY[k], m_VelocityZ[k] }, m_Mass[k],
+              entityBounds[instanceToEntityIndex[k]], totalCorrection, numCorrections, totalVelocityChange);
+          }
+        }
+
+        // Apply Accumulated Position Correction and Velocity Change (Averaged)
+        if (numCorrections > 0.0f) {
+          myPos += totalCorrection / numCorrections;
+          myVel += totalVelocityChange / numCorrections;
+        }
+
+        // Nan/Inf Safety & Final Clamp
+        if (std::isnan(myPos.x) || std::isinf(myPos.x)) myPos = glm::vec3(0.0f);
+        myPos = glm::clamp(myPos, glm::vec3(-limit), glm::vec3(limit));
+
+        transforms[i].position = myPos;
+        motions[i].velocity = myVel;
+      }
+    });
+  }
+
+  void CPUPhysics::BuildRadixTree(const std::vector<Transform>& transforms, const std::vector<Motion>& motions, float globalBounds) {
+    size_t numBodies = transforms.size();
+    size_t leafOffset = numBodies - 1;
+    size_t numNodes = 2 * numBodies - 1;
+
+    m_MortonPairs.resize(numBodies);
+    m_Nodes.resize(numNodes);
+    m_Parents.resize(numNodes);
+    m_Visits.assign(numBodies, 0);
+
+    // 1. Morton Codes (10 bits per axis inside globalBounds)
+    m_ThreadPool.ParallelFor(0, numBodies, GRAIN_SIZE * 16, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        glm::vec3 unitPos = (transforms[i].position + glm::vec3(globalBounds)) / (2.0f * globalBounds);
+        glm::uvec3 cell = glm::uvec3(glm::clamp(unitPos * 1024.0f, glm::vec3(0.0f), glm::vec3(1023.0f)));
+        m_MortonPairs[i] = { (ExpandBits(cell.x) << 2) | (ExpandBits(cell.y) << 1) | ExpandBits(cell.z), (unsigned int)i };
+      }
+    });
+
+    // 2. Sort along the Curve (ties by body, as the stable GPU radix sort leaves them)
+    SortPairs(m_MortonPairs);
+
+    // Length of the common key prefix of sorted bodies i and j (duplicate keys fall back to the index)
+    auto delta = [&](long long i, long long j) -> int {
+      if (j < 0 || j >= (long long)numBodies) return -1;
+
+      unsigned int keyI = m_MortonPairs[i].cellID;
+      unsigned int keyJ = m_MortonPairs[j].cellID;
+      if (keyI == keyJ) return 32 + std::countl_zero((unsigned int)(i ^ j));
+
+      return std::countl_zero(keyI ^ keyJ);
+    };
+
+    // 3. Tree (Leaves + Internal Nodes)
+    m_Parents[0] = NO_PARENT;
+
+    m_ThreadPool.ParallelFor(0, numBodies, GRAIN_SIZE * 4, [&](size_t begin, size_t end) {
+      for (size_t n = begin; n < end; ++n) {
+        unsigned int body = m_MortonPairs[n].instanceID;
+        glm::vec3 position = transforms[body].position;
+        m_Nodes[leafOffset + n] = { position, motions[body].mass, position, -1, position, (int)body };
+
+        if (n >= leafOffset) continue;
+
+        long long i = (long long)n;
+        int d = (delta(i, i + 1) - delta(i, i - 1)) >= 0 ? 1 : -1;
+        int deltaMin = delta(i, i - d);
+
+        long long lengthMax = 2;
+        while (delta(i, i + lengthMax * d) > deltaMin) lengthMax *= 2;
+
+        long long length = 0;
+        for (long long t = lengthMax / 2; t >= 1; t /= 2) {
+          if (delta(i, i + (length + t) * d) > deltaMin) length += t;
+        }
+        long long j = i + length * d;
+
+        int deltaNode = delta(i, j);
+        long long s = 0;
+        long long t = length;
+        do {
+          t = (t + 1) >> 1;
+          if (delta(i, i + (s + t) * d) > deltaNode) s += t;
+        } while (t > 1);
+        long long split = i + s * d + std::min(d, 0);
+
+        int left = (int)((std::min(i, j) == split) ? (long long)leafOffset + split : split);
+        int right = (int)((std::max(i, j) == split + 1) ? (long long)leafOffset + split + 1 : split + 1);
+
+        m_Nodes[n].left = left;
+        m_Nodes[n].right = right;
+        m_Parents[left] = (unsigned int)n;
+        m_Parents[right] = (unsigned int)n;
+      }
+    });
+  }
+
+  void CPUPhysics::MergeTreeNodes() {
+    size_t numBodies = m_MortonPairs.size();
+    size_t leafOffset = numBodies - 1;
+
+    // Mass, Center of Mass and Bounds (Bottom-Up, the second child to arrive merges)
+    m_ThreadPool.ParallelFor(0, numBodies, GRAIN_SIZE * 4, [&](size_t begin, size_t end) {
+      for (size_t n = begin; n < end; ++n) {
+        unsigned int node = m_Parents[leafOffset + n];
+
+        while (node != NO_PARENT) {
+          if (std::atomic_ref<unsigned int>(m_Visits[node]).fetch_add(1, std::memory_order_acq_rel) == 0) break;
+
+          const BarnesHutNode& left = m_Nodes[m_Nodes[node].left];
+          const BarnesHutNode& right = m_Nodes[m_Nodes[node].right];
+
+          float mass = left.mass + right.mass;
+          m_Nodes[node].centerOfMass = (mass > 0.0f)
+            ? (left.centerOfMass * left.mass + right.centerOfMass * right.mass) / mass
+            : (left.centerOfMass + right.centerOfMass) * 0.5f;
+          m_Nodes[node].mass = mass;
+          m_Nodes[node].boundsMin = glm::min(left.boundsMin, right.boundsMin);
+          m_Nodes[node].boundsMax = glm::max(left.boundsMax, right.boundsMax);
+
+          node = m_Parents[node];
+        }
+      }
+    });
+  }
+
+  void CPUPhysics::EnableBarnesHutGravity(const std::vector<Transform>& transforms, std::vector<Motion>& motions,
+    float gravityConstant, float globalBounds, float theta, float softening) {
+    size_t numBodies = transforms.size();
+    if (numBodies == 0) return;
+
+    size_t leafOffset = numBodies - 1;
+
+    // 1. Tree (Morton Order), then Mass, Center of Mass and Bounds
+    BuildRadixTree(transforms, motions, globalBounds);
+    MergeTreeNodes();
+
+    // 2. Forces (Tree Walk in Morton Order)
+    float theta2 = theta * theta;
+    float softening2 = softening * softening;
+
+    m_ThreadPool.ParallelFor(0, numBodies, 256, [&](size_t begin, size_t end) {
+      constexpr int STACK_SIZE = 64;
+      int stack[STACK_SIZE];
+
+      for (size_t n = begin; n < end; ++n) {
+        unsigned int body = m_MortonPairs[n].instanceID;
+        glm::vec3 position = transforms[body].position;
+        glm::vec3 acceleration(0.0f);
+
+        int top = 0;
+        stack[top++] = 0;
+
+        while (top > 0) {
+          int index = stack[--top];
+          const BarnesHutNode& node = m_Nodes[index];
+
+          glm::vec3 difference = node.centerOfMass - position;
+          float distSq = glm::dot(difference, difference);
+
+          if (index >= (int)leafOffset) {
+            if (node.right == (int)body) continue;
+          } else {
+            // Open nodes that look too large from here (size / distance >= theta) or that contain the body
+            glm::vec3 extent = node.boundsMax - node.boundsMin;
+            float size = std::max(extent.x, std::max(extent.y, extent.z));
+            bool inside = glm::all(glm::greaterThanEqual(position, node.boundsMin)) && glm::all(glm::lessThanEqual(position, node.boundsMax));
+
+            if ((inside || size * size >= theta2 * distSq) && top + 2 <= STACK_SIZE) {
+              stack[top++] = node.left;
+              stack[top++] = node.right;
+              continue;
+            }
+          }
+
+          // Plummer softened: a = G * m * r / (|r|^2 + eps^2)^(3/2)
+          float invDist = 1.0f / std::sqrt(distSq + softening2);
+          acceleration += gravityConstant * node.mass * invDist * invDist * invDist * difference;
+        }
+
+        motions[body].acceleration += acceleration;
+      }
+    });
+  }
+
+  void CPUPhysics::EnableBVHCollision(std::vector<Transform>& transforms, std::vector<Motion>& motions,
+    const std::vector<unsigned int>& instanceToEntityIndex, const std::vector<Bound>& entityBounds,
+    const std::vector<FluidMaterial>& entityFluidMaterials, float globalBounds) {
+    size_t numInstances = transforms.size();
+    if (numInstances == 0) return;
+
+    size_t leafOffset = numInstances - 1;
+
+    // 1. Snapshot in instance order (replaces any grid snapshot)
+    for (auto* array : { &m_PositionX, &m_PositionY, &m_PositionZ, &m_VelocityX, &m_VelocityY, &m_VelocityZ, &m_Mass, &m_Radius, &m_FluidActive }) {
+      array->resize(numInstances);
+    }
+    m_SortedInstances.clear();
+
+    m_ThreadPool.ParallelFor(0, numInstances, GRAIN_SIZE * 16, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        unsigned int entity = instanceToEntityIndex[i];
+        m_PositionX[i] = transforms[i].position.x;
+        m_PositionY[i] = transforms[i].position.y;
+        m_PositionZ[i] = transforms[i].position.z;
+        m_VelocityX[i] = motions[i].velocity.x;
+        m_VelocityY[i] = motions[i].velocity.y;
+        m_VelocityZ[i] = motions[i].velocity.z;
+        m_Mass[i] = motions[i].mass;
+        m_Radius[i] = entityBounds[entity].size * 0.5f;
+        m_FluidActive[i] = entityFluidMaterials[entity].active == 1 ? 1.0f : 0.0f;
+      }
+    });
+
+    // 2. Tree over the instance AABBs (leaves grow by their radius before the bounds merge)
+    BuildRadixTree(transforms, motions, globalBounds);
+
+    m_ThreadPool.ParallelFor(0, numInstances, GRAIN_SIZE * 16, [&](size_t begin, size_t end) {
+      for (size_t n = begin; n < end; ++n) {
+        BarnesHutNode& leaf = m_Nodes[leafOffset + n];
+        leaf.boundsMin -= glm::vec3(m_Radius[leaf.right]);
+        leaf.boundsMax += glm::vec3(m_Radius[leaf.right]);
+      }
+    });
+
+    MergeTreeNodes();
+
+    // 3. Contacts (every leaf whose box overlaps the instance's box, walked in Morton order)
+    m_ThreadPool.ParallelFor(0, numInstances, 256, [&](size_t begin, size_t end) {
+      constexpr int STACK_SIZE = 64;
+      int stack[STACK_SIZE];
+
+      for (size_t n = begin; n < end; ++n) {
+        unsigned int i = m_MortonPairs[n].instanceID;
+        const Bound& myBound = entityBounds[instanceToEntityIndex[i]];
+        if (myBound.active == 0) continue;
+
+        glm::vec3 myPos = { m_PositionX[i], m_PositionY[i], m_PositionZ[i] };
+        glm::vec3 myVel = { m_VelocityX[i], m_VelocityY[i], m_VelocityZ[i] };
+        float myMass = m_Mass[i];
+        float myRadius = m_Radius[i];
+        bool myFluid = m_FluidActive[i] != 0.0f;
+
+        // World Boundary Collision (Box)
+        float limit = globalBounds - myRadius;
+        ClampToWall(myPos.x, myVel.x, limit, myBound.bounciness);
+        ClampToWall(myPos.y, myVel.y, limit, myBound.bounciness);
+        ClampToWall(myPos.z, myVel.z, limit, myBound.bounciness);
+
+        glm::vec3 totalCorrection(0.0f);
+        float numCorrections = 0.0f;
+        glm::vec3 totalVelocityChange(0.0f);
+
+        const glm::vec3 boxMin = myPos - glm::vec3(myRadius);
+        const glm::vec3 boxMax = myPos + glm::vec3(myRadius);
+
+        int top = 0;
+        stack[top++] = 0;
+
+        while (top > 0) {
+          const BarnesHutNode& node = m_Nodes[stack[--top]];
+          if (glm::any(glm::lessThan(node.boundsMax, boxMin)) || glm::any(glm::greaterThan(node.boundsMin, boxMax))) continue;
+
+          if (node.left != -1) {
+            if (top + 2 <= STACK_SIZE) {
+              stack[top++] = node.left;
+              stack[top++] = node.right;
+            }
+            continue;
+          }
+
+          // Candidate pair (both fluid is left to SPH)
+          unsigned int k = (unsigned int)node.right;
+          if (k == i || (myFluid && m_FluidActive[k] != 0.0f)) continue;
+
+          ResolveContact(myPos, myVel, myMass, myBound,
+            { m_PositionX[k], m_PositionY[k], m_PositionZ[k] }, { m_VelocityX[k], m_VelocityY[k], m_VelocityZ[k] }, m_Mass[k],
+            entityBounds[instanceToEntityIndex[k]], totalCorrection, numCorrections, totalVelocityChange);
+        }
+
+        // Apply Accumulated Position Correction and Velocity Change (Averaged)
+        if (numCorrections > 0.0f) {
+          myPos += totalCorrection / numCorrections;
+          myVel += totalVelocityChange / numCorrections;
+        }
+
+        // Nan/Inf Safety & Final Clamp
+        if (std::isnan(myPos.x) || std::isinf(myPos.x)) myPos = glm::vec3(0.0f);
+        myPos = glm::clamp(myPos, glm::vec3(-limit), glm::vec3(limit));
+
+        transforms[i].position = myPos;
+        motions[i].velocity = myVel;
+      }
+    });
+  }
+
+  void CPUPhysics::SortPairs(std::vector<GridPair>& pairs) {
+    auto byKey = [](const GridPair& a, const GridPair& b) {
+      return a.cellID < b.cellID || (a.cellID == b.cellID && a.instanceID < b.instanceID);
+    };
+
+    // Sort one run per thread, then merge neighbouring runs until one is left
+    size_t runSize = std::max<size_t>(GRAIN_SIZE * 16, (pairs.size() + m_ThreadPool.GetThreadCount() - 1) / m_ThreadPool.GetThreadCount());
+
+    m_ThreadPool.ParallelFor(0, pairs.size(), runSize, [&](size_t begin, size_t end) {
+      std::sort(pairs.begin() + begin, pairs.begin() + end, byKey);
+    });
+
+    for (; runSize < pairs.size(); runSize *= 2) {
+      size_t merges = (pairs.size() + 2 * runSize - 1) / (2 * runSize);
+
+      m_ThreadPool.ParallelFor(0, merges, 1, [&](size_t begin, size_t end) {
+        for (size_t m = begin; m < end; ++m) {
+          size_t first = m * 2 * runSize;
+          size_t middle = std::min(pairs.size(), first + runSize);
+          size_t last = std::min(pairs.size(), first + 2 * runSize);
+          std::inplace_merge(pairs.begin() + first, pairs.begin() + middle, pairs.begin() + last, byKey);
+        }
+      });
+    }
+  }
+
+}
@@ -0,0 +1,35 @@
+#include "Spade/Core/Commands.hpp"
+
+namespace Spade {
+
+  void CommandBuffer::Apply(Universe& universe) {
+    m_Created.assign(m_PendingCount, INVALID_ENTITY_ID);
+
+    for (Command& command : m_Commands) {
+      if (command.type == CreateCommand) {
+        m_Created[command.pending] = universe.CreateEntityID();
+        continue;
+      }
+
+      // Pending entities resolve to the ID their create command received
+      const EntityID entity = (command.pending == NOT_PENDING) ? command.entity : m_Created[command.pending];
+      if (!universe.IsAlive(entity)) continue;
+
+      if (command.type == DestroyCommand) {
+        universe.DestroyEntity(entity);
+      } else {
+        command.apply(universe, entity);
+      }
+    }
+
+    m_Commands.clear();
+    m_PendingCount = 0;
+  }
+
+  void CommandBuffer::Apply(std::vector<CommandBuffer>& buffers, Universe& universe) {
+    for (CommandBuffer& buffer : buffers) {
+      buffer.Apply(universe);
+    }
+  }
+
+}
@@ -1,5 +1,7 @@
 #include "Spade/Core/Components.hpp"
 
+#include <algorithm>
+
 namespace Spade {
 
   glm::mat4 TransformComponent::GetModel() const {
@@ -22,13 +24,33 @@ namespace Spade {
     return glm::rotate(transform.rotation, glm::vec3(0.0f, 1.0f, 0.0f));
   }
 
-  MeshComponent::~MeshComponent() {
-    if (VAO) glDeleteVertexArrays(1, &VAO);
-    if (VBO) glDeleteBuffers(1, &VBO);
-    if (EBO) glDeleteBuffers(1, &EBO);
+  void MeshComponent::SetInstanceTransform(size_t index, const Transform& transform) {
+    instanceTransforms[index] = transform;
+    MarkInstancesChanged(index, 1);
+  }
+
+  void MeshComponent::SetInstanceMotion(size_t index, const Motion& motion) {
+    instanceMotions[index] = motion;
+    MarkInstancesChanged(index, 1);
+  }
+
+  void MeshComponent::SetInstanceMaterial(size_t index, const Material& material) {
+    instanceMaterials[index] = material;
+    MarkInstancesChanged(index, 1);
+  }
+
+  void MeshComponent::MarkInstancesChanged(size_t first, size_t count) {
+    instanceVersions.resize(instanceTransforms.size(), 0);
+
+    const size_t last = std::min(first + count, instanceVersions.size());
+    if (first >= last) return;
+
+    std::fill(instanceVersions.begin() + first, instanceVersions.begin() + last, Internal::NextChangeVersion());
   }
 
   void MeshComponent::SpawnInstancesInSphere(float radius, glm::vec3 center, int count) {
+    const size_t firstSpawned = instanceTransforms.size();
+
     // Setup Random Number Generator
     std::random_device rd;
     std::mt19937 gen(rd());
@@ -72,9 +94,13 @@ namespace Spade {
       instanceMotions.push_back(motion);
       instanceMaterials.push_back(material);
     }
+
+    MarkInstancesChanged(firstSpawned, count);
   }
 
   void MeshComponent::SpawnInstancesInCube(float size, glm::vec3 center, int count) {
+    const size_t firstSpawned = instanceTransforms.size();
+
     // 1. Calculate dimensions
     // We estimate how many points per axis we need to fit the totalCount.
     // We use ceil() to ensure we have enough room for all particles.
@@ -117,6 +143,8 @@ namespace Spade {
         }
       }
     }
+
+    MarkInstancesChanged(firstSpawned, instanceTransforms.size() - firstSpawned);
   }
 
 
@@ -124,18 +152,24 @@ namespace Spade {
     for (int i = 0; i < instanceTransforms.size(); ++i) {
       instanceMaterials[i].color = color;
     }
+
+    MarkInstancesChanged(0, instanceTransforms.size());
   }
 
   void MeshComponent::SetVelocity(glm::vec3 velocity) {
     for (int i = 0; i < instanceTransforms.size(); ++i) {
       instanceMotions[i].velocity = velocity;
     }
+
+    MarkInstancesChanged(0, instanceTransforms.size());
   }
 
   void MeshComponent::SetMass(float mass) {
     for (int i = 0; i < instanceTransforms.size(); ++i) {
       instanceMotions[i].mass = mass;
     }
+
+    MarkInstancesChanged(0, instanceTransforms.size());
   }
 
   void MeshComponent::RandomizeColor() {
@@ -152,6 +186,8 @@ namespace Spade {
         1.0f
       };
     }
+
+    MarkInstancesChanged(0, instanceTransforms.size());
   }
 
   void MeshComponent::RandomizeVelocity() {
@@ -167,6 +203,8 @@ namespace Spade {
         dis(gen)
       };
     }
+
+    MarkInstancesChanged(0, instanceTransforms.size());
   }
 
 
@@ -1,9 +1,87 @@
 #include "Spade/Core/Engine.hpp"
 
 #include <ranges>
+#include <bit>
+#include <algorithm>
+#include <numeric>
+#include <cstring>
+
+#if defined(_WIN32)
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+  #include <psapi.h>
+#elif defined(__linux__)
+  #include <fstream>
+  #include <unistd.h>
+#endif
 
 namespace Spade {
 
+  // Load table entry of an instance that compaction removed
+  static constexpr unsigned int INVALID_INSTANCE = 0xFFFFFFFF;
+
+  // Traversal stack of [SYSTEM]BVHCollision.comp (STACK_SIZE). A path holds at most one internal node per Morton bit
+  // (30) and per index bit (duplicate codes, 32 for any unsigned count), and the walk keeps one sibling per level.
+  static constexpr unsigned int BVH_STACK_SIZE = 64;
+  static_assert(30 + 32 + 1 <= BVH_STACK_SIZE, "BVH traversal stack is shallower than the deepest radix tree");
+
+  // Calls write(first, count) once per run of consecutive indices (ascending)
+  static void ForEachRun(const std::vector<size_t>& indices, const std::function<void(size_t, size_t)>& write) {
+    size_t i = 0;
+    while (i < indices.size()) {
+      size_t count = 1;
+      while (i + count < indices.size() && indices[i + count] == indices[i] + count) count++;
+      write(indices[i], count);
+      i += count;
+    }
+  }
+
+  // Hash, random numbers and shapes of Emit.comp, so the CPU device emits the same instances
+  static unsigned int EmitHash(unsigned int x) {
+    const unsigned int state = x * 747796405u + 2891336453u;
+    const unsigned int word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+  }
+
+  static float EmitRandom(unsigned int& state) {
+    state = EmitHash(state);
+    return (float)(state >> 8) / 16777216.0f;
+  }
+
+  static glm::vec3 EmitDirection(unsigned int& state) {
+    const float z = EmitRandom(state) * 2.0f - 1.0f;
+    const float theta = EmitRandom(state) * 6.28318530718f;
+    const float horizontal = std::sqrt(std::max(1.0f - z * z, 0.0f));
+    return { horizontal * std::cos(theta), horizontal * std::sin(theta), z };
+  }
+
+  static void EmitInstance(const EmitRecord& record, unsigned int rank, Transform& transform, Motion& motion, Material& material) {
+    unsigned int state = EmitHash(record.seed + rank);
+
+    glm::vec3 offset;
+    if (record.shape == EmitSphere) {
+      const glm::vec3 direction = EmitDirection(state);
+      offset = direction * (record.size * std::cbrt(EmitRandom(state)));
+    } else {
+      offset.x = EmitRandom(state) - 0.5f;
+      offset.y = EmitRandom(state) - 0.5f;
+      offset.z = EmitRandom(state) - 0.5f;
+      offset *= record.size;
+    }
+
+    transform = Transform();
+    transform.position = record.center + offset;
+
+    motion = Motion();
+    motion.velocity = record.velocity + record.speed * EmitDirection(state);
+    motion.mass = record.mass;
+
+    material = Material();
+    material.color = record.color;
+  }
+
   Engine::~Engine() {
     // Delete Programs
     for (const auto &id: m_ShaderPrograms | std::views::values) {
@@ -15,30 +93,55 @@ namespace Spade {
       glDeleteBuffers(1, &id);
     }
 
-    glfwDestroyWindow(m_GLFWwindow);
-    glfwTerminate();
-  }
+    if (m_SortQuery) glDeleteQueries(1, &m_SortQuery);
 
-  void Engine::LoadCameraBuffers(Universe &universe) {
-    auto& cameraPool = universe.GetPool<CameraComponent>();
-    auto& transformPool = universe.GetPool<TransformComponent>();
+    if (m_SceneVAO) glDeleteVertexArrays(1, &m_SceneVAO);
 
-    for (size_t c = 0; c < cameraPool.m_Data.size(); ++c) {
-      CameraComponent& cameraComponent = cameraPool.m_Data[c];
-      const EntityID entityID = cameraPool.m_IndexToEntity[c];
+    for (GLsync fence : m_UploadFences) {
+      if (fence) glDeleteSync(fence);
+    }
 
-      TransformComponent* transformComponent = transformPool.Get(entityID);
+    // Readback staging buffers are not named buffer objects
+    for (const PendingReadback& readback : m_Readbacks) {
+      if (readback.fence) glDeleteSync(readback.fence);
+      if (readback.staging.buffer) glDeleteBuffers(1, &readback.staging.buffer);
+    }
+    for (const PendingSpatialQueries& queries : m_SpatialQueries) {
+      if (queries.fence) glDeleteSync(queries.fence);
+      if (queries.rangeStaging.buffer) glDeleteBuffers(1, &queries.rangeStaging.buffer);
+      if (queries.hitStaging.buffer) glDeleteBuffers(1, &queries.hitStaging.buffer);
+    }
+    for (const ReadbackStaging& staging : m_FreeReadbackStaging) {
+      glDeleteBuffers(1, &staging.buffer);
+    }
 
-      if (cameraComponent.isActive) {
+    if (m_OffscreenFramebuffer) {
+      glDeleteFramebuffers(1, &m_OffscreenFramebuffer);
+      glDeleteRenderbuffers(1, &m_OffscreenColor);
+      glDeleteRenderbuffers(1, &m_OffscreenDepth);
+    }
 
-        m_ActiveCamera.camera.projection = glm::perspective(glm::radians(cameraComponent.fov),
-          ((float)m_WindowSize.x / (float)m_WindowSize.y), cameraComponent.nearPlane, cameraComponent.farPlane);
-        m_ActiveCamera.camera.view = glm::inverse(transformComponent->GetModel());
-        m_ActiveCamera.camera.viewInverse = m_ActiveCamera.camera.view;
-        m_ActiveCamera.camera.projInverse = glm::inverse(m_ActiveCamera.camera.projection);
-        break;
-      }
+    // CPU-only engines never initialized GLFW
+    if (m_GLFWwindow) {
+      glfwDestroyWindow(m_GLFWwindow);
+      glfwTerminate();
     }
+  }
+
+  void Engine::LoadCameraBuffers(Universe &universe) {
+    // First active camera
+    universe.View<CameraComponent, TransformComponent>().Each([&](EntityID, CameraComponent& cameraComponent, TransformComponent& transformComponent) {
+      if (!cameraComponent.isActive) return true;
+
+      m_ActiveCamera.camera.projection = glm::perspective(glm::radians(cameraComponent.fov),
+        ((float)m_WindowSize.x / (float)m_WindowSize.y), cameraComponent.nearPlane, cameraComponent.farPlane);
+      m_ActiveCamera.camera.view = glm::inverse(transformComponent.GetModel());
+      m_ActiveCamera.camera.viewInverse = m_ActiveCamera.camera.view;
+      m_ActiveCamera.camera.projInverse = glm::inverse(m_ActiveCamera.camera.projection);
+      return false;
+    });
+
+    if (!HasContext()) return;
 
     if (!m_BufferObjects.contains("Camera")) {
       m_BufferObjects["Camera"] = Resources::CreateBuffer();
@@ -48,18 +151,48 @@ namespace Spade {
     } else {
       // Update Camera Data
       Resources::UpdateUniformBufferObject<Camera>(m_ActiveCamera.camera, m_BufferObjects["Camera"]);
+      m_UploadedBytes += sizeof(Camera);
     }
 
   }
 
   void Engine::LoadInstanceBuffers(Universe &universe) {
+    auto& meshPool = universe.GetPool<MeshComponent>();
+    auto& emitterPool = universe.GetPool<EmitterComponent>();
+
+    // Instances a mesh holds at most: its own plus the capacity of its emitter
+    auto meshCapacity = [&](size_t i) {
+      const EmitterComponent* emitterComponent = emitterPool.Get(meshPool.m_IndexToEntity[i]);
+      return meshPool.m_Data[i].instanceTransforms.size() + (emitterComponent ? emitterComponent->capacity : 0);
+    };
+
+    // Same meshes with the same instance counts and capacities: only instances stamped since the last load are uploaded
+    bool layoutCurrent = m_MeshInstanceCounts.size() == meshPool.m_Data.size()
+      && meshPool.m_StructureVersion <= m_InstanceUploadVersion
+      && emitterPool.m_StructureVersion <= m_InstanceUploadVersion
+      && (!HasContext() || m_BufferObjects.contains("InstanceTransform"));
+    for (size_t i = 0; layoutCurrent && i < meshPool.m_Data.size(); ++i) {
+      layoutCurrent = meshPool.m_Data[i].instanceTransforms.size() == m_MeshInstanceCounts[i]
+        && meshCapacity(i) == m_MeshInstanceCapacities[i];
+    }
+
+    if (layoutCurrent) {
+      LoadChangedInstances(universe);
+      return;
+    }
+
+    m_InstanceUploadVersion = Internal::GetChangeVersion();
+    m_MeshInstanceCounts.clear();
+    m_MeshInstanceCapacities.clear();
+
+    // Fresh CPU data replaces anything still waiting in the sorted arrays (and every emitted instance)
+    m_GridScatterPending = false;
+    InvalidateGrid();
 
     m_InstanceTransforms.clear();
     m_InstanceMotions.clear();
     m_InstanceMaterials.clear();
     m_InstanceToEntityIndex.clear();
-    
-    auto& meshPool = universe.GetPool<MeshComponent>();
 
     unsigned int bufferSize = 0;
 
@@ -76,259 +209,1673 @@ namespace Spade {
     for(size_t i = 0; i < meshPool.m_Data.size(); ++i) {
       MeshComponent& meshComponent = meshPool.m_Data[i];
 
-      // Load Vertex Buffer info
-      if (meshComponent.VAO == 0) {
-        meshComponent.VAO = Resources::CreateVertexArrayObject();
-        meshComponent.VBO = Resources::CreateBuffer();
-        meshComponent.EBO = Resources::CreateBuffer();
-
-        Resources::BindVertexArrayObject(meshComponent.VAO);
-        Resources::UploadVertexBufferObject(meshComponent.mesh.vertices, meshComponent.VBO);
-        Resources::UploadElementBufferObject(meshComponent.mesh.indices, meshComponent.EBO);
-
-        // Position
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-
-        // Normal
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
-
-        // TexCoords
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
-      }
-
       meshComponent.instanceStartIndex = m_InstanceToEntityIndex.size();
       // Insert Values into buffers
       m_InstanceTransforms.insert(m_InstanceTransforms.end(), meshComponent.instanceTransforms.begin(), meshComponent.instanceTransforms.end());
       m_InstanceMotions.insert(m_InstanceMotions.end(), meshComponent.instanceMotions.begin(), meshComponent.instanceMotions.end());
       m_InstanceMaterials.insert(m_InstanceMaterials.end(), meshComponent.instanceMaterials.begin(), meshComponent.instanceMaterials.end());
       m_InstanceToEntityIndex.insert(m_InstanceToEntityIndex.end(), meshComponent.instanceTransforms.size(), i);
+      m_MeshInstanceCounts.push_back(meshComponent.instanceTransforms.size());
+      m_MeshInstanceCapacities.push_back(meshCapacity(i));
+    }
+
+    // Emitted instances are appended after the loaded ones, up to the total capacity
+    m_InstanceCount = bufferSize;
+    m_InstanceCapacity = std::accumulate(m_MeshInstanceCapacities.begin(), m_MeshInstanceCapacities.end(), size_t(0));
+    m_MeshEmittedCounts.assign(meshPool.m_Data.size(), 0);
+
+    // Every instance starts alive, and each loaded instance is its own original index until a compaction
+    m_LoadedInstanceCount = bufferSize;
+    m_MeshLoadedCounts = m_MeshInstanceCounts;
+    m_InstanceAlive.assign(bufferSize, 1);
+    m_LoadedInstances.resize(bufferSize);
+    std::iota(m_LoadedInstances.begin(), m_LoadedInstances.end(), 0u);
+
+    if (HasContext()) {
+      UploadInstanceBuffers();
+      UploadSceneGeometry(universe);
+    }
+  }
+
+  void Engine::LoadCollisionBuffers(Universe &universe) {
+    
+    auto [meshPool, boundingPool] = universe.GetPools<MeshComponent, BoundingComponent>();
+
+    const ChangeVersion since = m_BoundUploadVersion;
+    m_BoundUploadVersion = Internal::GetChangeVersion();
+
+    // Bounds follow the mesh order, an Add / Remove in either pool rebuilds them
+    const bool rebuild = m_EntityBounds.size() != meshPool.m_Data.size()
+      || meshPool.m_StructureVersion > since || boundingPool.m_StructureVersion > since
+      || (HasContext() && !m_BufferObjects.contains("EntityBound"));
+
+    if (!rebuild) {
+      std::vector<size_t> changed;
+      for (size_t i = 0; i < meshPool.m_Data.size(); ++i) {
+        const size_t index = boundingPool.IndexOf(meshPool.m_IndexToEntity[i]);
+        if (boundingPool.m_Versions[index] <= since) continue;
+
+        m_EntityBounds[i] = boundingPool.m_Data[index].bound;
+        changed.push_back(i);
+      }
+
+      if (!HasContext()) return;
+
+      // One write per run of changed bounds
+      ForEachRun(changed, [&](size_t first, size_t count) {
+        Resources::UpdateShaderStorageBufferObject<Bound>(m_EntityBounds.data() + first, count, first, m_BufferObjects["EntityBound"]);
+        m_UploadedBytes += count * sizeof(Bound);
+      });
+      return;
+    }
+
+    std::vector<Bound> bounds;
+
+    // Loop through each mesh
+    for(size_t i = 0; i < meshPool.m_Data.size(); ++i) {
+      const EntityID entityID = meshPool.m_IndexToEntity[i];
+
+      const BoundingComponent* boundingComponent = boundingPool.Get(entityID);
+      bounds.push_back(boundingComponent->bound);
+    }
+
+    m_EntityBounds = bounds;
+    if (!HasContext()) return;
+
+    m_UploadedBytes += bounds.size() * sizeof(Bound);
+
+    if (!m_BufferObjects.contains("EntityBound")) {
+      m_BufferObjects["EntityBound"] = Resources::CreateBuffer();
+      // Allocate once
+      Resources::UploadShaderStorageBufferObject<Bound>(bounds, m_BufferObjects["EntityBound"]);
+      Resources::BindShaderStorageToLocation(4, m_BufferObjects["EntityBound"]);
+    } else {
+      Resources::UpdateShaderStorageBufferObject<Bound>(bounds, m_BufferObjects["EntityBound"]);
+    }
+  }
+
+  void Engine::LoadFluidBuffers(Universe &universe) {
+
+    auto [meshPool, fluidPool] = universe.GetPools<MeshComponent, FluidComponent>();
+
+    const ChangeVersion since = m_FluidUploadVersion;
+    m_FluidUploadVersion = Internal::GetChangeVersion();
+
+    // Fluid materials follow the mesh order, an Add / Remove in either pool rebuilds them
+    const bool rebuild = m_EntityFluidMaterials.size() != meshPool.m_Data.size()
+      || meshPool.m_StructureVersion > since || fluidPool.m_StructureVersion > since
+      || (HasContext() && !m_BufferObjects.contains("EntityFluidMaterial"));
+
+    if (!rebuild) {
+      std::vector<size_t> changed;
+      for (size_t i = 0; i < meshPool.m_Data.size(); ++i) {
+        const size_t index = fluidPool.IndexOf(meshPool.m_IndexToEntity[i]);
+        if (fluidPool.m_Versions[index] <= since) continue;
+
+        m_EntityFluidMaterials[i] = fluidPool.m_Data[index].fluidMaterial;
+        changed.push_back(i);
+      }
+
+      if (!HasContext()) return;
+
+      // One write per run of changed materials
+      ForEachRun(changed, [&](size_t first, size_t count) {
+        Resources::UpdateShaderStorageBufferObject<FluidMaterial>(m_EntityFluidMaterials.data() + first, count, first, m_BufferObjects["EntityFluidMaterial"]);
+        m_UploadedBytes += count * sizeof(FluidMaterial);
+      });
+      return;
+    }
+
+    std::vector<FluidMaterial> fluids;
+
+    // Loop through each mesh
+    for(size_t i = 0; i < meshPool.m_Data.size(); ++i) {
+      const EntityID entityID = meshPool.m_IndexToEntity[i];
+
+      const FluidComponent* fluidComponent = fluidPool.Get(entityID);
+      fluids.push_back(fluidComponent->fluidMaterial);
+    }
+
+    m_EntityFluidMaterials = fluids;
+    if (!HasContext()) return;
+
+    m_UploadedBytes += fluids.size() * sizeof(FluidMaterial);
+
+    if (!m_BufferObjects.contains("EntityFluidMaterial")) {
+      m_BufferObjects["EntityFluidMaterial"] = Resources::CreateBuffer();
+      // Allocate once
+      Resources::UploadShaderStorageBufferObject<FluidMaterial>(fluids, m_BufferObjects["EntityFluidMaterial"]);
+      Resources::BindShaderStorageToLocation(13, m_BufferObjects["EntityFluidMaterial"]);
+    } else {
+      Resources::UpdateShaderStorageBufferObject<FluidMaterial>(fluids, m_BufferObjects["EntityFluidMaterial"]);
+    }
+  }
+
+  void Engine::LoadGridBuffers() {
+
+    // Calculate Next Power of Two for Bitonic Sort (over the capacity, emitters grow the instance count)
+    size_t sortedSize = 1;
+    while(sortedSize < m_InstanceCapacity) sortedSize <<= 1;
+
+    // GridHead/GridTail are sized and cleared on the GPU by BuildGrid (hashed or dense)
+    std::vector<GridPair> pairs(sortedSize, { 0xFFFFFFFF, 0xFFFFFFFF });
+
+    InvalidateGrid();
+    if (!HasContext()) return;
+
+    // 3. Initialize Buffers (the sorted arrays are gathered on every build, only their size matters)
+    ReserveShaderStorageBuffer("GridPair", sortedSize * sizeof(GridPair));
+    ReserveShaderStorageBuffer("SortedTransform", m_InstanceCapacity * sizeof(Transform));
+    ReserveShaderStorageBuffer("SortedMotion", m_InstanceCapacity * sizeof(Motion));
+    Resources::UpdateShaderStorageBufferObject<GridPair>(pairs, m_BufferObjects["GridPair"]);
+
+    Resources::BindShaderStorageToLocation(10, m_BufferObjects["GridPair"]);
+    Resources::BindShaderStorageToLocation(11, m_BufferObjects["SortedTransform"]);
+    Resources::BindShaderStorageToLocation(12, m_BufferObjects["SortedMotion"]);
+  }
+
+  void Engine::EnableMotion(float deltaTime) {
+    if (m_InstanceCount == 0) return;
+
+    if (m_SimulationDevice == CPUDevice) {
+      GetCPUPhysics().EnableMotion(m_InstanceTransforms, m_InstanceMotions, deltaTime);
+      InvalidateGrid();
+      return;
+    }
+
+    if (!m_ShaderPrograms.contains("Motion")) {
+      m_ShaderPrograms["Motion"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]Motion.comp");
+    }
+
+    ScatterGrid();
+    InvalidateGrid();
+
+    GLuint groups = (m_InstanceCount + 63) / 64;
+
+    Resources::UseProgram(m_ShaderPrograms["Motion"]);
+    Resources::SetUniformFloat(m_ShaderPrograms["Motion"], "deltaTime", deltaTime);
+    Resources::SetUniformUnsignedInt(m_ShaderPrograms["Motion"], "numInstances", m_InstanceCount);
+
+    glDispatchCompute(groups, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+  }
+
+  void Engine::EnableGravity(float globalGravity) {
+    if (m_InstanceCount == 0) return;
+
+    if (m_SimulationDevice == CPUDevice) {
+      GetCPUPhysics().EnableGravity(m_InstanceMotions, globalGravity);
+      InvalidateGrid();
+      return;
+    }
+
+    if (!m_ShaderPrograms.contains("Gravity")) {
+      m_ShaderPrograms["Gravity"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]GlobalGravity.comp");
+    }
+
+    ScatterGrid();
+    InvalidateGrid();
+
+    GLuint groups = (m_InstanceCount + 63) / 64;
+
+    Resources::UseProgram( m_ShaderPrograms["Gravity"]);
+    Resources::SetUniformFloat( m_ShaderPrograms["Gravity"], "globalGravity", globalGravity);
+    Resources::SetUniformUnsignedInt(m_ShaderPrograms["Gravity"], "numInstances", m_InstanceCount);
+
+    glDispatchCompute(groups, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+  }
+  
+  void Engine::EnableEmitters(Universe& universe, float deltaTime) {
+    auto& meshPool = universe.GetPool<MeshComponent>();
+    if (m_MeshInstanceCapacities.size() != meshPool.m_Data.size()) {
+      throw EngineException("LoadInstanceBuffers must be called before EnableEmitters");
+    }
+
+    // 1. Instances per Emitter (fractions carry over, anything past the reserved capacity is dropped)
+    std::vector<EmitRecord> records;
+    unsigned int numEmitted = 0;
+
+    universe.View<EmitterComponent, MeshComponent>().Each([&](EntityID entity, EmitterComponent& emitterComponent, MeshComponent&) {
+      if (!emitterComponent.isActive) return;
+
+      emitterComponent.accumulator += emitterComponent.rate * deltaTime;
+      const float whole = std::floor(emitterComponent.accumulator);
+      emitterComponent.accumulator -= whole;
+
+      const size_t meshIndex = meshPool.IndexOf(entity);
+      const size_t available = m_MeshInstanceCapacities[meshIndex] - m_MeshLoadedCounts[meshIndex] - m_MeshEmittedCounts[meshIndex];
+      const size_t count = std::min<size_t>((size_t)whole + emitterComponent.burst, available);
+      emitterComponent.burst = 0;
+      if (count == 0) return;
+
+      EmitRecord record{};
+      record.center = emitterComponent.center;
+      record.size = emitterComponent.size;
+      record.velocity = emitterComponent.velocity;
+      record.speed = emitterComponent.speed;
+      record.color = emitterComponent.color;
+      record.entityIndex = meshIndex;
+      record.first = numEmitted;
+      record.count = count;
+      record.shape = emitterComponent.shape;
+      record.seed = m_EmitSeed + numEmitted;
+      record.mass = emitterComponent.mass;
+      records.push_back(record);
+
+      m_MeshEmittedCounts[meshIndex] += count;
+      numEmitted += count;
+    });
+
+    if (numEmitted == 0) return;
+    m_EmitSeed += numEmitted;
+
+    const size_t first = m_InstanceCount;
+
+    // 2. CPU device: appended to the caches (the render still needs the tables of the new instances)
+    if (m_SimulationDevice == CPUDevice || !HasContext()) {
+      m_InstanceTransforms.resize(first + numEmitted);
+      m_InstanceMotions.resize(first + numEmitted);
+      m_InstanceMaterials.resize(first + numEmitted);
+      m_InstanceToEntityIndex.resize(first + numEmitted);
+      m_InstanceAlive.resize(first + numEmitted, 1);
+
+      for (const EmitRecord& record : records) {
+        for (unsigned int rank = 0; rank < record.count; ++rank) {
+          const size_t instance = first + record.first + rank;
+          EmitInstance(record, rank, m_InstanceTransforms[instance], m_InstanceMotions[instance], m_InstanceMaterials[instance]);
+          m_InstanceToEntityIndex[instance] = record.entityIndex;
+        }
+      }
+
+      m_InstanceCount += numEmitted;
+      InvalidateGrid();
+      if (!HasContext()) return;
+
+      std::vector<unsigned int> instanceSlots(numEmitted);
+      std::iota(instanceSlots.begin(), instanceSlots.end(), (unsigned int)first);
+
+      Resources::UpdateShaderStorageBufferObject<Material>(m_InstanceMaterials.data() + first, numEmitted, first, m_BufferObjects["InstanceMaterial"]);
+      Resources::UpdateShaderStorageBufferObject<unsigned int>(m_InstanceToEntityIndex.data() + first, numEmitted, first, m_BufferObjects["InstanceToEntityIndex"]);
+      Resources::UpdateShaderStorageBufferObject<unsigned int>(instanceSlots.data(), numEmitted, first, m_BufferObjects["InstanceSlot"]);
+      Resources::UpdateShaderStorageBufferObject<unsigned int>(instanceSlots.data(), numEmitted, first, m_BufferObjects["SlotInstance"]);
+      m_UploadedBytes += numEmitted * (sizeof(Material) + 3 * sizeof(unsigned int));
+      return;
+    }
+
+    if (!m_ShaderPrograms.contains("Emit")) {
+      m_ShaderPrograms["Emit"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]Emit.comp");
     }
 
+    ScatterGrid();
+    InvalidateGrid();
+
+    // 3. GPU device: the counter starts at the live count and every new instance takes its slot with an atomic add
+    const unsigned int instanceCount = first;
+    ReserveShaderStorageBuffer("InstanceCounter", sizeof(unsigned int));
+    Resources::UpdateShaderStorageBufferObject<unsigned int>(&instanceCount, 1, 0, m_BufferObjects["InstanceCounter"]);
+    Resources::BindShaderStorageToLocation(34, m_BufferObjects["InstanceCounter"]);
 
-    if (!m_BufferObjects.contains("InstanceTransform")) {
-      m_BufferObjects["InstanceTransform"] = Resources::CreateBuffer();
-      m_BufferObjects["InstanceMotion"] = Resources::CreateBuffer();
-      m_BufferObjects["InstanceMaterial"] = Resources::CreateBuffer();
-      m_BufferObjects["InstanceToEntityIndex"] = Resources::CreateBuffer();
+    // 4. Generate (emitters are read in place from the upload ring, nothing per instance is uploaded)
+    const size_t recordBytes = records.size() * sizeof(EmitRecord);
+    std::memcpy(MapUploadRegion(recordBytes), records.data(), recordBytes);
 
-      // Upload
-      Resources::UploadShaderStorageBufferObject<Transform>(m_InstanceTransforms, m_BufferObjects["InstanceTransform"]);
-      Resources::UploadShaderStorageBufferObject<Motion>(m_InstanceMotions, m_BufferObjects["InstanceMotion"]);
-      Resources::UploadShaderStorageBufferObject<Material>(m_InstanceMaterials, m_BufferObjects["InstanceMaterial"]);
-      Resources::UploadShaderStorageBufferObject<unsigned int>(m_InstanceToEntityIndex, m_BufferObjects["InstanceToEntityIndex"]);
+    SubmitUploadRegion({}, [&](BufferID ring, size_t offset) {
+      glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 33, ring, offset, recordBytes);
+
+      Resources::UseProgram(m_ShaderPrograms["Emit"]);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["Emit"], "numRecords", records.size());
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["Emit"], "numEmitted", numEmitted);
+      glDispatchCompute((numEmitted + 63) / 64, 1, 1);
+      glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    });
+
+    // Every emitter was clamped to its capacity, so the counter ends exactly here
+    m_InstanceCount += numEmitted;
+  }
+
+  void Engine::KillOutOfBounds(float globalBounds) {
+    if (m_InstanceCount == 0) return;
+
+    if (m_SimulationDevice == CPUDevice || !HasContext()) {
+      for (size_t i = 0; i < m_InstanceCount; ++i) {
+        const glm::vec3 position = glm::abs(m_InstanceTransforms[i].position);
+        if (position.x > globalBounds || position.y > globalBounds || position.z > globalBounds) m_InstanceAlive[i] = 0;
+      }
+      return;
+    }
+
+    if (!m_ShaderPrograms.contains("BoundsKill")) {
+      m_ShaderPrograms["BoundsKill"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]BoundsKill.comp");
+    }
+
+    // Only flags change, the grid stays valid
+    ScatterGrid();
+
+    Resources::UseProgram(m_ShaderPrograms["BoundsKill"]);
+    Resources::SetUniformFloat(m_ShaderPrograms["BoundsKill"], "globalBounds", globalBounds);
+    Resources::SetUniformUnsignedInt(m_ShaderPrograms["BoundsKill"], "numInstances", m_InstanceCount);
+    glDispatchCompute((m_InstanceCount + 63) / 64, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+  }
+
+  void Engine::CompactInstances() {
+    if (m_InstanceCount == 0) return;
+
+    const size_t meshCount = m_MeshInstanceCounts.size();
+    const unsigned int numInstances = m_InstanceCount;
+    std::vector<unsigned int> meshCounts(2 * meshCount, 0);
+
+    // 1. CPU device: stable compaction of the caches (the render tables are then rebuilt from them)
+    if (m_SimulationDevice == CPUDevice || !HasContext()) {
+      std::vector<unsigned int> compactIndices(numInstances, INVALID_INSTANCE);
+      unsigned int numCompacted = 0;
+
+      for (size_t i = 0; i < numInstances; ++i) {
+        if (!m_InstanceAlive[i]) continue;
+
+        meshCounts[2 * m_InstanceToEntityIndex[i] + (i >= m_LoadedInstanceCount ? 1 : 0)]++;
+        compactIndices[i] = numCompacted;
+
+        m_InstanceTransforms[numCompacted] = m_InstanceTransforms[i];
+        m_InstanceMotions[numCompacted] = m_InstanceMotions[i];
+        m_InstanceMaterials[numCompacted] = m_InstanceMaterials[i];
+        m_InstanceToEntityIndex[numCompacted] = m_InstanceToEntityIndex[i];
+        numCompacted++;
+      }
+      if (numCompacted == numInstances) return;
+
+      m_InstanceTransforms.resize(numCompacted);
+      m_InstanceMotions.resize(numCompacted);
+      m_InstanceMaterials.resize(numCompacted);
+      m_InstanceToEntityIndex.resize(numCompacted);
+      m_InstanceAlive.assign(numCompacted, 1);
+
+      for (unsigned int& instance : m_LoadedInstances) {
+        if (instance != INVALID_INSTANCE) instance = compactIndices[instance];
+      }
+    } else {
+      if (!m_ShaderPrograms.contains("CompactMark")) {
+        m_ShaderPrograms["CompactMark"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]CompactMark.comp");
+        m_ShaderPrograms["CompactScatter"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]CompactScatter.comp");
+        m_ShaderPrograms["CompactFinish"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]CompactFinish.comp");
+      }
+
+      // Survivors are gathered from the instance buffers, pending grid writes land first
+      ScatterGrid();
+
+      const GLuint groups = (numInstances + 63) / 64;
+      const unsigned int numLoadedInstances = m_LoadedInstances.size();
+
+      ReserveShaderStorageBuffer("CompactIndex", std::max<size_t>(m_InstanceCapacity, 1) * sizeof(unsigned int));
+      ReserveShaderStorageBuffer("CompactCount", std::max<size_t>(meshCounts.size(), 1) * sizeof(unsigned int));
+      Resources::UpdateShaderStorageBufferObject<unsigned int>(meshCounts, m_BufferObjects["CompactCount"]);
+      Resources::BindShaderStorageToLocation(38, m_BufferObjects["CompactIndex"]);
+      Resources::BindShaderStorageToLocation(39, m_BufferObjects["CompactCount"]);
+
+      // 2. Mark (keep flag per original instance, survivors counted per mesh)
+      Resources::UseProgram(m_ShaderPrograms["CompactMark"]);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["CompactMark"], "numInstances", numInstances);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["CompactMark"], "numLoaded", m_LoadedInstanceCount);
+      glDispatchCompute(groups, 1, 1);
+      glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+      // 3. Read back the counts (two per mesh, the only sync point), nothing else runs when every instance lives
+      Resources::DownloadShaderStorageBufferObject<unsigned int>(meshCounts, m_BufferObjects["CompactCount"]);
+      const unsigned int numCompacted = std::accumulate(meshCounts.begin(), meshCounts.end(), 0u);
+      if (numCompacted == numInstances) return;
+
+      // 4. New Indices (exclusive scan of the keep flags, survivors keep their order)
+      PrefixScan(m_BufferObjects["CompactIndex"], numInstances);
+
+      // 5. Scatter survivors into the sorted buffers (swapped in below, so sized for the whole capacity)
+      ReserveShaderStorageBuffer("SortedTransform", m_InstanceCapacity * sizeof(Transform));
+      ReserveShaderStorageBuffer("SortedMotion", m_InstanceCapacity * sizeof(Motion));
+      ReserveShaderStorageBuffer("SortedMaterial", m_InstanceCapacity * sizeof(Material));
+      ReserveShaderStorageBuffer("SortedEntityIndex", m_InstanceCapacity * sizeof(unsigned int));
+
+      Resources::BindShaderStorageToLocation(11, m_BufferObjects["SortedTransform"]);
+      Resources::BindShaderStorageToLocation(12, m_BufferObjects["SortedMotion"]);
+      Resources::BindShaderStorageToLocation(22, m_BufferObjects["SortedMaterial"]);
+      Resources::BindShaderStorageToLocation(23, m_BufferObjects["SortedEntityIndex"]);
+
+      Resources::UseProgram(m_ShaderPrograms["CompactScatter"]);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["CompactScatter"], "numInstances", numInstances);
+      glDispatchCompute(groups, 1, 1);
+      glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+      // 6. Finish (identity slot tables, every survivor alive, loaded instances follow their new index)
+      Resources::UseProgram(m_ShaderPrograms["CompactFinish"]);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["CompactFinish"], "numInstances", numInstances);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["CompactFinish"], "numCompacted", numCompacted);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["CompactFinish"], "numLoadedInstances", numLoadedInstances);
+      glDispatchCompute((std::max(numInstances, numLoadedInstances) + 63) / 64, 1, 1);
+      glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+      // 7. Swap (the compacted copies become the instance buffers)
+      std::swap(m_BufferObjects["InstanceTransform"], m_BufferObjects["SortedTransform"]);
+      std::swap(m_BufferObjects["InstanceMotion"], m_BufferObjects["SortedMotion"]);
+      std::swap(m_BufferObjects["InstanceMaterial"], m_BufferObjects["SortedMaterial"]);
+      std::swap(m_BufferObjects["InstanceToEntityIndex"], m_BufferObjects["SortedEntityIndex"]);
 
-      // Bind
       Resources::BindShaderStorageToLocation(5, m_BufferObjects["InstanceTransform"]);
       Resources::BindShaderStorageToLocation(6, m_BufferObjects["InstanceMotion"]);
       Resources::BindShaderStorageToLocation(7, m_BufferObjects["InstanceMaterial"]);
       Resources::BindShaderStorageToLocation(8, m_BufferObjects["InstanceToEntityIndex"]);
+      Resources::BindShaderStorageToLocation(11, m_BufferObjects["SortedTransform"]);
+      Resources::BindShaderStorageToLocation(12, m_BufferObjects["SortedMotion"]);
+    }
+
+    // 8. Counts (emitters refill the freed capacity of their mesh)
+    m_InstanceCount = 0;
+    m_LoadedInstanceCount = 0;
+    for (size_t i = 0; i < meshCount; ++i) {
+      m_MeshLoadedCounts[i] = meshCounts[2 * i];
+      m_MeshEmittedCounts[i] = meshCounts[2 * i + 1];
+      m_InstanceCount += meshCounts[2 * i] + meshCounts[2 * i + 1];
+      m_LoadedInstanceCount += meshCounts[2 * i];
+    }
+
+    InvalidateGrid();
+
+    // The CPU device rebuilds the render tables of the survivors
+    if (m_SimulationDevice == CPUDevice && HasContext()) UploadInstanceBuffers();
+  }
+
+  void Engine::BuildGrid(float globalBounds, float cellSize) {
+    if (m_InstanceCount == 0) return;
+
+    // Reuse the grid (and sorted arrays) while nothing has moved since it was built
+    if (m_GridEpoch == m_InstanceEpoch && m_GridMode == m_GridBuildMode && m_InstanceOrder == m_GridBuildOrder &&
+        m_GridBounds == globalBounds && m_GridCellSize == cellSize) {
+      return;
+    }
+
+    // Dense Grid Size (Matches the implicit gridDim of the grid shaders, checked before it can wrap)
+    const double gridDim = std::max(1.0f, std::floor((globalBounds * 2.0f) / cellSize));
+    if (m_GridMode == DenseGrid && gridDim * gridDim * gridDim > (double)MAX_DENSE_GRID_CELLS) {
+      throw EngineException("DenseGrid needs more than MAX_DENSE_GRID_CELLS cells, use a larger cellSize, a smaller globalBounds or SparseGrid");
+    }
+
+    // Rebuilding reads the instance buffers, so pending sorted writes land first
+    ScatterGrid();
+
+    m_GridEpoch = m_InstanceEpoch;
+    m_GridBuildMode = m_GridMode;
+    m_GridBuildOrder = m_InstanceOrder;
+    m_GridBounds = globalBounds;
+    m_GridCellSize = cellSize;
+
+    if (m_SimulationDevice == CPUDevice) {
+      GetCPUPhysics().BuildGrid(m_InstanceTransforms, m_InstanceMotions, globalBounds, cellSize, m_GridMode);
+      return;
+    }
+
+    // 1. Initialize Shaders
+    if (!m_ShaderPrograms.contains("GridBuild")) {
+      m_ShaderPrograms["GridClear"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]GridClear.comp");
+      m_ShaderPrograms["GridBuild"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]GridBuild.comp");
+
+      m_ShaderPrograms["GridOffset"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]GridOffsets.comp");
+      m_ShaderPrograms["GridReorder"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]GridReorder.comp");
+      m_ShaderPrograms["GridScatter"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]GridScatter.comp");
+
+      m_ShaderPrograms["DenseGridCount"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]DenseGridCount.comp");
+      m_ShaderPrograms["DenseGridPlace"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]DenseGridPlace.comp");
+      m_ShaderPrograms["SparseGridCount"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]SparseGridCount.comp");
+    }
+
+    size_t numInstances = m_InstanceCount;
+
+    size_t sortedSize = 1;
+    while(sortedSize < numInstances) sortedSize <<= 1;
+
+    // Spatial Hash Table Size (Fixed, Sparse: at least twice the instance count, which bounds the occupied cells)
+    const unsigned int hashTableSize = (m_GridMode == SparseGrid) ? std::bit_ceil(std::max<unsigned int>((unsigned int)numInstances * 2, 64)) : 1 << 21;
+    m_GridTableSize = hashTableSize;
+
+    const size_t totalCells = (m_GridMode == DenseGrid) ? (size_t)(gridDim * gridDim * gridDim) : hashTableSize;
+
+    GLuint groups = (numInstances + 63) / 64;
+
+    // Cell Ranges [GridHead, GridTail) are sized on the GPU, nothing is uploaded
+    ReserveShaderStorageBuffer("GridHead", totalCells * sizeof(int));
+    ReserveShaderStorageBuffer("GridTail", totalCells * sizeof(int));
+    Resources::BindShaderStorageToLocation(9, m_BufferObjects["GridHead"]);
+    Resources::BindShaderStorageToLocation(19, m_BufferObjects["GridTail"]);
+
+    // Sparse Table (owner instance and packed cell per slot, empty slots are cleared with the grid)
+    if (m_GridMode == SparseGrid) {
+      ReserveShaderStorageBuffer("SparseOwner", totalCells * sizeof(unsigned int));
+      ReserveShaderStorageBuffer("SparseKey", totalCells * 2 * sizeof(unsigned int));
+      Resources::BindShaderStorageToLocation(45, m_BufferObjects["SparseOwner"]);
+      Resources::BindShaderStorageToLocation(46, m_BufferObjects["SparseKey"]);
+    }
+
+    // 1. Clear Grid (Head, Tail, Sparse Table)
+    Resources::UseProgram(m_ShaderPrograms["GridClear"]);
+    Resources::SetUniformInt(m_ShaderPrograms["GridClear"], "totalCells", totalCells);
+    Resources::SetUniformUnsignedInt(m_ShaderPrograms["GridClear"], "sparseTable", m_GridMode == SparseGrid);
+    glDispatchCompute((totalCells + 63) / 64, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    if (m_GridMode != HashedGrid) {
+      ReserveShaderStorageBuffer("GridPairAlt", numInstances * sizeof(GridPair));
+      Resources::BindShaderStorageToLocation(14, m_BufferObjects["GridPairAlt"]);
+
+      BeginSortQuery();
+
+      // 2. Count Particles per Cell (Tail holds counts, pairs hold the rank within the cell, sparse cells claim a slot first)
+      const char* countProgram = (m_GridMode == SparseGrid) ? "SparseGridCount" : "DenseGridCount";
+      Resources::UseProgram(m_ShaderPrograms[countProgram]);
+      Resources::SetUniformFloat(m_ShaderPrograms[countProgram], "globalBounds", globalBounds);
+      Resources::SetUniformFloat(m_ShaderPrograms[countProgram], "cellSize", cellSize);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms[countProgram], "numInstances", numInstances);
+      if (m_GridMode == SparseGrid) {
+        Resources::SetUniformUnsignedInt(m_ShaderPrograms[countProgram], "hashTableSize", hashTableSize);
+      }
+      glDispatchCompute(groups, 1, 1);
+      glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+      m_SortDispatches++;
+
+      // 3. Cell Starts (Exclusive Scan of the Counts)
+      Resources::CopyBufferObject(m_BufferObjects["GridTail"], m_BufferObjects["GridHead"], totalCells * sizeof(int));
+      m_SortDispatches += PrefixScan(m_BufferObjects["GridHead"], totalCells);
+
+      // 4. Place Pairs at Start + Rank (Counting Sort, Tail becomes the cell end)
+      Resources::UseProgram(m_ShaderPrograms["DenseGridPlace"]);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["DenseGridPlace"], "numInstances", numInstances);
+      glDispatchCompute(groups, 1, 1);
+      glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+      m_SortDispatches++;
+
+      EndSortQuery();
     } else {
-      // Update
+      // 2. Build Key-Value Pairs
+      Resources::UseProgram(m_ShaderPrograms["GridBuild"]);
+      Resources::SetUniformFloat(m_ShaderPrograms["GridBuild"], "globalBounds", globalBounds);
+      Resources::SetUniformFloat(m_ShaderPrograms["GridBuild"], "cellSize", cellSize);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["GridBuild"], "hashTableSize", hashTableSize); // Hash Table Size
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["GridBuild"], "numInstances", numInstances);
+      // Bitonic sorts the whole power of two, so the padding past the live count is reset as well
+      glDispatchCompute(m_SortAlgorithm == RadixSort ? groups : (sortedSize + 63) / 64, 1, 1);
+      glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+      // 3. Sort Pairs by Cell
+      BeginSortQuery();
+      if (m_SortAlgorithm == RadixSort) {
+        // SpatialOrder left the instances in key order, so the keys stay sorted until an instance changes cells
+        m_SortDispatches += RadixSortPairs("GridPair", numInstances, std::bit_width(hashTableSize - 1), m_InstanceOrder == SpatialOrder);
+      } else {
+        BitonicSortGridPairs(sortedSize);
+      }
+      EndSortQuery();
+
+      // 4. Find Offsets (Populate GridHead, GridTail)
+      Resources::UseProgram(m_ShaderPrograms["GridOffset"]);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["GridOffset"], "numInstances", numInstances);
+      glDispatchCompute(groups, 1, 1);
+      glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
 
-      Resources::UpdateShaderStorageBufferObject<Transform>(m_InstanceTransforms, m_BufferObjects["InstanceTransform"]);
-      Resources::UpdateShaderStorageBufferObject<Motion>(m_InstanceMotions, m_BufferObjects["InstanceMotion"]);
-      Resources::UpdateShaderStorageBufferObject<Material>(m_InstanceMaterials, m_BufferObjects["InstanceMaterial"]);
-      Resources::UpdateShaderStorageBufferObject<unsigned int>(m_InstanceToEntityIndex, m_BufferObjects["InstanceToEntityIndex"]);
+    if (m_InstanceOrder == SpatialOrder) {
+      // 5. Permute the Instances into Cell Order (the sorted arrays are the instance buffers)
+      PermuteInstances(numInstances);
+      return;
     }
+
+    // 5. Reorder (Gather)
+    Resources::BindShaderStorageToLocation(11, m_BufferObjects["SortedTransform"]);
+    Resources::BindShaderStorageToLocation(12, m_BufferObjects["SortedMotion"]);
+
+    Resources::UseProgram(m_ShaderPrograms["GridReorder"]);
+    Resources::SetUniformUnsignedInt(m_ShaderPrograms["GridReorder"], "numInstances", numInstances);
+    glDispatchCompute(groups, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
   }
 
-  void Engine::LoadCollisionBuffers(Universe &universe) {
-    
+  void Engine::PermuteInstances(size_t numInstances) {
+    if (!m_ShaderPrograms.contains("InstancePermute")) {
+      m_ShaderPrograms["InstancePermute"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]InstancePermute.comp");
+    }
+
+    GLuint groups = (numInstances + 63) / 64;
+
+    // Swapped in as the instance buffers below, so sized for the whole capacity
+    ReserveShaderStorageBuffer("SortedMaterial", m_InstanceCapacity * sizeof(Material));
+    ReserveShaderStorageBuffer("SortedEntityIndex", m_InstanceCapacity * sizeof(unsigned int));
+    ReserveShaderStorageBuffer("SortedSlotInstance", m_InstanceCapacity * sizeof(unsigned int));
+    ReserveShaderStorageBuffer("SortedAlive", m_InstanceCapacity * sizeof(unsigned int));
+
+    Resources::BindShaderStorageToLocation(11, m_BufferObjects["SortedTransform"]);
+    Resources::BindShaderStorageToLocation(12, m_BufferObjects["SortedMotion"]);
+    Resources::BindShaderStorageToLocation(22, m_BufferObjects["SortedMaterial"]);
+    Resources::BindShaderStorageToLocation(23, m_BufferObjects["SortedEntityIndex"]);
+    Resources::BindShaderStorageToLocation(24, m_BufferObjects["SortedSlotInstance"]);
+    Resources::BindShaderStorageToLocation(36, m_BufferObjects["SortedAlive"]);
+
+    // 1. Gather Transform/Motion in Cell Order
+    Resources::UseProgram(m_ShaderPrograms["GridReorder"]);
+    Resources::SetUniformUnsignedInt(m_ShaderPrograms["GridReorder"], "numInstances", numInstances);
+    glDispatchCompute(groups, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // 2. Gather Material/Entity Index/Alive Flag, move the Slot Tables, pairs now point at their own slot
+    Resources::UseProgram(m_ShaderPrograms["InstancePermute"]);
+    Resources::SetUniformUnsignedInt(m_ShaderPrograms["InstancePermute"], "numInstances", numInstances);
+    glDispatchCompute(groups, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // 3. Swap (the gathered copies become the instance buffers, no copy back)
+    std::swap(m_BufferObjects["InstanceTransform"], m_BufferObjects["SortedTransform"]);
+    std::swap(m_BufferObjects["InstanceMotion"], m_BufferObjects["SortedMotion"]);
+    std::swap(m_BufferObjects["InstanceMaterial"], m_BufferObjects["SortedMaterial"]);
+    std::swap(m_BufferObjects["InstanceToEntityIndex"], m_BufferObjects["SortedEntityIndex"]);
+    std::swap(m_BufferObjects["SlotInstance"], m_BufferObjects["SortedSlotInstance"]);
+    std::swap(m_BufferObjects["InstanceAlive"], m_BufferObjects["SortedAlive"]);
+
+    Resources::BindShaderStorageToLocation(5, m_BufferObjects["InstanceTransform"]);
+    Resources::BindShaderStorageToLocation(6, m_BufferObjects["InstanceMotion"]);
+    Resources::BindShaderStorageToLocation(7, m_BufferObjects["InstanceMaterial"]);
+    Resources::BindShaderStorageToLocation(8, m_BufferObjects["InstanceToEntityIndex"]);
+    Resources::BindShaderStorageToLocation(21, m_BufferObjects["SlotInstance"]);
+    Resources::BindShaderStorageToLocation(35, m_BufferObjects["InstanceAlive"]);
+
+    // Grid systems read and write the instance buffers directly
+    Resources::BindShaderStorageToLocation(11, m_BufferObjects["InstanceTransform"]);
+    Resources::BindShaderStorageToLocation(12, m_BufferObjects["InstanceMotion"]);
+  }
+
+  void Engine::BeginSortQuery() {
+    // Timed with a query read back on a later build, never stalls
+    if (m_SortQuery == 0) {
+      glGenQueries(1, &m_SortQuery);
+    } else {
+      GLuint available = 0;
+      glGetQueryObjectuiv(m_SortQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+      if (available) {
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(m_SortQuery, GL_QUERY_RESULT, &elapsed);
+        m_SortTime = elapsed / 1000000.0f;
+      }
+    }
+
+    m_SortDispatches = 0;
+    glBeginQuery(GL_TIME_ELAPSED, m_SortQuery);
+  }
+
+  void Engine::EndSortQuery() {
+    glEndQuery(GL_TIME_ELAPSED);
+  }
+
+  void Engine::BitonicSortGridPairs(unsigned int sortedSize) {
+    if (!m_ShaderPrograms.contains("BitonicSort")) {
+      m_ShaderPrograms["BitonicSort"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]BitonicSort.comp");
+    }
+
+    GLuint setSizeGroups = (sortedSize + 63) / 64;
+
+    // Bitonic Sort (Iterative Dispatch)
+    Resources::UseProgram(m_ShaderPrograms["BitonicSort"]);
+    // k = block width (2, 4, 8, ... N)
+    // j = comparison distance (k/2, k/4, ... 1)
+    for (unsigned int k = 2; k <= sortedSize; k <<= 1) {
+      for (unsigned int j = k >> 1; j > 0; j >>= 1) {
+        Resources::SetUniformUnsignedInt(m_ShaderPrograms["BitonicSort"], "j", j);
+        Resources::SetUniformUnsignedInt(m_ShaderPrograms["BitonicSort"], "k", k);
+        glDispatchCompute(setSizeGroups, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        m_SortDispatches++;
+      }
+    }
+  }
+
+  unsigned int Engine::RadixSortPairs(const std::string& pairs, unsigned int numKeys, unsigned int keyBits, bool skipSorted) {
+    if (!m_ShaderPrograms.contains("RadixHistogram")) {
+      m_ShaderPrograms["RadixHistogram"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]RadixHistogram.comp");
+      m_ShaderPrograms["RadixScatter"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]RadixScatter.comp");
+    }
+    if (skipSorted && !m_ShaderPrograms.contains("RadixSortCheck")) {
+      m_ShaderPrograms["RadixSortCheck"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]RadixSortCheck.comp");
+      m_ShaderPrograms["RadixSortArgs"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]RadixSortArgs.comp");
+      m_ShaderPrograms["RadixCopy"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]RadixCopy.comp");
+    }
+
+    // 8 bits per pass, 256 keys per workgroup, only the real keys are sorted (no padding)
+    GLuint groups = (numKeys + 255) / 256;
+    unsigned int histogramSize = groups * 256;
+
+    ReserveShaderStorageBuffer(pairs + "Alt", numKeys * sizeof(GridPair));
+    ReserveShaderStorageBuffer("RadixHistogram", histogramSize * sizeof(unsigned int));
+
+    BufferID pairsIn = m_BufferObjects[pairs];
+    BufferID pairsOut = m_BufferObjects[pairs + "Alt"];
+    unsigned int dispatches = 0;
+    Resources::BindShaderStorageToLocation(16, m_BufferObjects["RadixHistogram"]);
+
+    // 0. Coherence Check (the GPU counts descents and writes the pass dispatches itself, the CPU never waits)
+    if (skipSorted) {
+      const unsigned int zero = 0;
+      ReserveShaderStorageBuffer("RadixSortState", 7 * sizeof(unsigned int));
+      Resources::UpdateShaderStorageBufferObject<unsigned int>(&zero, 1, 0, m_BufferObjects["RadixSortState"]);
+      Resources::BindShaderStorageToLocation(49, m_BufferObjects["RadixSortState"]);
+      Resources::BindShaderStorageToLocation(14, pairsIn);
+      Resources::BindShaderStorageToLocation(15, pairsOut);
+
+      Resources::UseProgram(m_ShaderPrograms["RadixSortCheck"]);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["RadixSortCheck"], "numKeys", numKeys);
+      glDispatchCompute((numKeys + 63) / 64, 1, 1);
+      glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+      Resources::UseProgram(m_ShaderPrograms["RadixSortArgs"]);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["RadixSortArgs"], "sortGroups", groups);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["RadixSortArgs"], "copyGroups", (numKeys + 63) / 64);
+      glDispatchCompute(1, 1, 1);
+      glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+
+      // Sorted keys are mirrored into the alternate buffer, so an odd pass count still ends on sorted keys
+      glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, m_BufferObjects["RadixSortState"]);
+      Resources::UseProgram(m_ShaderPrograms["RadixCopy"]);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["RadixCopy"], "numKeys", numKeys);
+      glDispatchComputeIndirect(4 * sizeof(unsigned int));
+      glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+      dispatches += 3;
+    }
+
+    // Radix passes are dispatched empty when the check found the keys sorted
+    auto dispatchPass = [&]() {
+      if (skipSorted) {
+        glDispatchComputeIndirect(sizeof(unsigned int));
+      } else {
+        glDispatchCompute(groups, 1, 1);
+      }
+    };
+
+    for (unsigned int bitOffset = 0; bitOffset < keyBits; bitOffset += 8) {
+      Resources::BindShaderStorageToLocation(14, pairsIn);
+      Resources::BindShaderStorageToLocation(15, pairsOut);
+
+      // 1. Per-Workgroup Digit Counts
+      Resources::UseProgram(m_ShaderPrograms["RadixHistogram"]);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["RadixHistogram"], "numKeys", numKeys);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["RadixHistogram"], "bitOffset", bitOffset);
+      dispatchPass();
+      glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+      dispatches++;
+
+      // 2. Global Digit Offsets
+      dispatches += PrefixScan(m_BufferObjects["RadixHistogram"], histogramSize);
+
+      // 3. Stable Scatter
+      Resources::UseProgram(m_ShaderPrograms["RadixScatter"]);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["RadixScatter"], "numKeys", numKeys);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["RadixScatter"], "bitOffset", bitOffset);
+      dispatchPass();
+      glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+      dispatches++;
+
+      std::swap(pairsIn, pairsOut);
+    }
+
+    // Odd pass count leaves the result in the alternate buffer
+    if (pairsIn != m_BufferObjects[pairs]) {
+      Resources::CopyBufferObject(pairsIn, m_BufferObjects[pairs], numKeys * sizeof(GridPair));
+    }
+
+    if (skipSorted) glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+
+    return dispatches;
+  }
+
+  unsigned int Engine::PrefixScan(const BufferID& buffer, unsigned int count) {
+    if (!m_ShaderPrograms.contains("PrefixScan")) {
+      m_ShaderPrograms["PrefixScan"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]PrefixScan.comp");
+      m_ShaderPrograms["PrefixScanAdd"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]PrefixScanAdd.comp");
+    }
+
+    struct ScanLevel {
+      BufferID buffer;
+      unsigned int dataOffset;
+      unsigned int count;
+      unsigned int sumsOffset;
+    };
+
+    // Each level scans blocks of 1024 and the block totals become the next level
+    std::vector<ScanLevel> levels = { { buffer, 0, count, 0 } };
+    unsigned int sumsSize = 0;
+
+    while (true) {
+      ScanLevel& level = levels.back();
+      unsigned int blocks = (level.count + 1023) / 1024;
+      level.sumsOffset = sumsSize;
+      sumsSize += blocks;
+
+      if (blocks <= 1) break;
+      levels.push_back({ 0, level.sumsOffset, blocks, 0 });
+    }
+
+    ReserveShaderStorageBuffer("ScanBlockSums", sumsSize * sizeof(unsigned int));
+    Resources::BindShaderStorageToLocation(18, m_BufferObjects["ScanBlockSums"]);
+
+    // 1. Scan Blocks (Down)
+    Resources::UseProgram(m_ShaderPrograms["PrefixScan"]);
+    for (auto& level : levels) {
+      if (level.buffer == 0) level.buffer = m_BufferObjects["ScanBlockSums"];
+
+      Resources::BindShaderStorageToLocation(17, level.buffer);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["PrefixScan"], "count", level.count);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["PrefixScan"], "dataOffset", level.dataOffset);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["PrefixScan"], "sumsOffset", level.sumsOffset);
+      glDispatchCompute((level.count + 1023) / 1024, 1, 1);
+      glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+
+    // 2. Add Scanned Block Totals (Up)
+    Resources::UseProgram(m_ShaderPrograms["PrefixScanAdd"]);
+    for (size_t l = levels.size() - 1; l-- > 0;) {
+      const ScanLevel& level = levels[l];
+
+      Resources::BindShaderStorageToLocation(17, level.buffer);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["PrefixScanAdd"], "count", level.count);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["PrefixScanAdd"], "dataOffset", level.dataOffset);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["PrefixScanAdd"], "sumsOffset", level.sumsOffset);
+      glDispatchCompute((level.count + 1023) / 1024, 1, 1);
+      glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+
+    // Dispatches issued
+    return levels.size() * 2 - 1;
+  }
+
+  void Engine::ReserveShaderStorageBuffer(const std::string& name, size_t size) {
+    if (!m_BufferObjects.contains(name)) {
+      m_BufferObjects[name] = Resources::CreateBuffer();
+    } else if (Resources::GetBufferObjectSize(m_BufferObjects[name]) >= size) {
+      return;
+    }
+
+    // Contents are not preserved when growing (scratch buffers only)
+    Resources::AllocateShaderStorageBufferObject(size, m_BufferObjects[name]);
+  }
+
+  void Engine::UploadInstanceBuffers() {
+    const size_t numInstances = m_InstanceCount;
+
+    // Every instance starts in its own slot (permuted later by SpatialOrder)
+    std::vector<unsigned int> instanceSlots(numInstances);
+    std::iota(instanceSlots.begin(), instanceSlots.end(), 0u);
+
+    // 1. Allocate the whole capacity (emitters write past the live instances)
+    const size_t capacity = std::max<size_t>(m_InstanceCapacity, 1);
+    ReserveShaderStorageBuffer("InstanceTransform", capacity * sizeof(Transform));
+    ReserveShaderStorageBuffer("InstanceMotion", capacity * sizeof(Motion));
+    ReserveShaderStorageBuffer("InstanceMaterial", capacity * sizeof(Material));
+    ReserveShaderStorageBuffer("InstanceToEntityIndex", capacity * sizeof(unsigned int));
+    ReserveShaderStorageBuffer("InstanceSlot", capacity * sizeof(unsigned int));
+    ReserveShaderStorageBuffer("SlotInstance", capacity * sizeof(unsigned int));
+    ReserveShaderStorageBuffer("InstanceAlive", capacity * sizeof(unsigned int));
+    ReserveShaderStorageBuffer("LoadedInstance", std::max<size_t>(m_LoadedInstances.size(), 1) * sizeof(unsigned int));
+
+    Resources::BindShaderStorageToLocation(5, m_BufferObjects["InstanceTransform"]);
+    Resources::BindShaderStorageToLocation(6, m_BufferObjects["InstanceMotion"]);
+    Resources::BindShaderStorageToLocation(7, m_BufferObjects["InstanceMaterial"]);
+    Resources::BindShaderStorageToLocation(8, m_BufferObjects["InstanceToEntityIndex"]);
+    Resources::BindShaderStorageToLocation(20, m_BufferObjects["InstanceSlot"]);
+    Resources::BindShaderStorageToLocation(21, m_BufferObjects["SlotInstance"]);
+    Resources::BindShaderStorageToLocation(35, m_BufferObjects["InstanceAlive"]);
+    Resources::BindShaderStorageToLocation(37, m_BufferObjects["LoadedInstance"]);
+
+    // 2. Upload the live instances (through the upload ring)
+    const size_t transformBytes = numInstances * sizeof(Transform);
+    const size_t motionBytes = numInstances * sizeof(Motion);
+    const size_t materialBytes = numInstances * sizeof(Material);
+    const size_t indexBytes = numInstances * sizeof(unsigned int);
+    const size_t loadedBytes = m_LoadedInstances.size() * sizeof(unsigned int);
+
+    unsigned char* upload = MapUploadRegion(transformBytes + motionBytes + materialBytes + 4 * indexBytes + loadedBytes);
+    std::memcpy(upload, m_InstanceTransforms.data(), transformBytes);
+    upload += transformBytes;
+    std::memcpy(upload, m_InstanceMotions.data(), motionBytes);
+    upload += motionBytes;
+    std::memcpy(upload, m_InstanceMaterials.data(), materialBytes);
+    upload += materialBytes;
+    std::memcpy(upload, m_InstanceToEntityIndex.data(), indexBytes);
+    upload += indexBytes;
+    std::memcpy(upload, instanceSlots.data(), indexBytes);
+    upload += indexBytes;
+    std::memcpy(upload, instanceSlots.data(), indexBytes);
+    upload += indexBytes;
+    std::memcpy(upload, m_InstanceAlive.data(), indexBytes);
+    upload += indexBytes;
+    std::memcpy(upload, m_LoadedInstances.data(), loadedBytes);
+
+    SubmitUploadRegion({
+      {"InstanceTransform", transformBytes},
+      {"InstanceMotion", motionBytes},
+      {"InstanceMaterial", materialBytes},
+      {"InstanceToEntityIndex", indexBytes},
+      {"InstanceSlot", indexBytes},
+      {"SlotInstance", indexBytes},
+      {"InstanceAlive", indexBytes},
+      {"LoadedInstance", loadedBytes}
+    });
+  }
+
+  void Engine::UpdateInstanceBuffers(Universe& universe) {
     auto& meshPool = universe.GetPool<MeshComponent>();
-    auto& boundingPool = universe.GetPool<BoundingComponent>();
+    const size_t numInstances = std::accumulate(m_MeshInstanceCounts.begin(), m_MeshInstanceCounts.end(), size_t(0));
 
-    std::vector<Bound> bounds;
+    // 1. Layout must match the last load (buffers are not resized here)
+    size_t instanceCount = 0;
+    for (const auto& meshComponent : meshPool.m_Data) {
+      if (meshComponent.instanceStartIndex != instanceCount) {
+        throw EngineException("UpdateInstanceBuffers: meshes changed since LoadInstanceBuffers");
+      }
+      instanceCount += meshComponent.instanceTransforms.size();
+    }
+    if (instanceCount != numInstances) {
+      throw EngineException("UpdateInstanceBuffers: instance count changed since LoadInstanceBuffers");
+    }
 
-    // Loop through each mesh
-    for(size_t i = 0; i < meshPool.m_Data.size(); ++i) {
-      MeshComponent& meshComponent = meshPool.m_Data[i];
-      const EntityID entityID = meshPool.m_IndexToEntity[i];
+    // Fresh CPU data replaces anything still waiting in the sorted arrays, and every emitted instance
+    m_GridScatterPending = false;
+    InvalidateGrid();
+    m_InstanceUploadVersion = Internal::GetChangeVersion();
+
+    m_InstanceCount = numInstances;
+    std::fill(m_MeshEmittedCounts.begin(), m_MeshEmittedCounts.end(), 0);
+    m_InstanceTransforms.resize(numInstances);
+    m_InstanceMotions.resize(numInstances);
+    m_InstanceMaterials.resize(numInstances);
+    m_InstanceToEntityIndex.resize(numInstances);
+
+    // Removed instances come back as well
+    m_LoadedInstanceCount = numInstances;
+    m_MeshLoadedCounts = m_MeshInstanceCounts;
+    m_InstanceAlive.assign(numInstances, 1);
+    m_LoadedInstances.resize(numInstances);
+    std::iota(m_LoadedInstances.begin(), m_LoadedInstances.end(), 0u);
+
+    // 2. CPU device: the caches are the simulation data (compaction may have shrunk the entity table, so it is refilled)
+    if (m_SimulationDevice == CPUDevice || !HasContext()) {
+      for (size_t i = 0; i < meshPool.m_Data.size(); ++i) {
+        const MeshComponent& meshComponent = meshPool.m_Data[i];
+        const size_t start = meshComponent.instanceStartIndex;
+        std::copy(meshComponent.instanceTransforms.begin(), meshComponent.instanceTransforms.end(), m_InstanceTransforms.begin() + start);
+        std::copy(meshComponent.instanceMotions.begin(), meshComponent.instanceMotions.end(), m_InstanceMotions.begin() + start);
+        std::copy(meshComponent.instanceMaterials.begin(), meshComponent.instanceMaterials.end(), m_InstanceMaterials.begin() + start);
+        std::fill(m_InstanceToEntityIndex.begin() + start, m_InstanceToEntityIndex.begin() + start + meshComponent.instanceTransforms.size(), (unsigned int)i);
+      }
+
+      // The renderer still reads the GPU tables (entity indices, slots reset, every instance alive and loaded)
+      if (HasContext()) UploadInstanceBuffers();
+      return;
+    }
+
+    // 3. GPU device: every mesh writes straight into mapped memory (slots reset, SpatialOrder may have moved them)
+    const size_t transformBytes = numInstances * sizeof(Transform);
+    const size_t motionBytes = numInstances * sizeof(Motion);
+    const size_t materialBytes = numInstances * sizeof(Material);
+    const size_t indexBytes = numInstances * sizeof(unsigned int);
+
+    unsigned char* upload = MapUploadRegion(transformBytes + motionBytes + materialBytes + 5 * indexBytes);
+    Transform* transforms = reinterpret_cast<Transform*>(upload);
+    Motion* motions = reinterpret_cast<Motion*>(upload + transformBytes);
+    Material* materials = reinterpret_cast<Material*>(upload + transformBytes + motionBytes);
+    unsigned int* entityIndices = reinterpret_cast<unsigned int*>(upload + transformBytes + motionBytes + materialBytes);
+    unsigned int* instanceSlots = entityIndices + numInstances;
+    unsigned int* slotInstances = instanceSlots + numInstances;
+    unsigned int* instanceAlive = slotInstances + numInstances;
+    unsigned int* loadedInstances = instanceAlive + numInstances;
+
+    for (size_t i = 0; i < meshPool.m_Data.size(); ++i) {
+      const MeshComponent& meshComponent = meshPool.m_Data[i];
+      const size_t start = meshComponent.instanceStartIndex;
+      const size_t count = meshComponent.instanceTransforms.size();
+
+      std::memcpy(transforms + start, meshComponent.instanceTransforms.data(), count * sizeof(Transform));
+      std::memcpy(motions + start, meshComponent.instanceMotions.data(), count * sizeof(Motion));
+      std::memcpy(materials + start, meshComponent.instanceMaterials.data(), count * sizeof(Material));
+      std::fill(entityIndices + start, entityIndices + start + count, (unsigned int)i);
+    }
+    std::iota(instanceSlots, instanceSlots + numInstances, 0u);
+    std::iota(slotInstances, slotInstances + numInstances, 0u);
+    std::fill(instanceAlive, instanceAlive + numInstances, 1u);
+    std::iota(loadedInstances, loadedInstances + numInstances, 0u);
+
+    SubmitUploadRegion({
+      {"InstanceTransform", transformBytes},
+      {"InstanceMotion", motionBytes},
+      {"InstanceMaterial", materialBytes},
+      {"InstanceToEntityIndex", indexBytes},
+      {"InstanceSlot", indexBytes},
+      {"SlotInstance", indexBytes},
+      {"InstanceAlive", indexBytes},
+      {"LoadedInstance", indexBytes}
+    });
+  }
+
+  void Engine::LoadChangedInstances(Universe& universe) {
+    auto& meshPool = universe.GetPool<MeshComponent>();
+
+    const ChangeVersion since = m_InstanceUploadVersion;
+    m_InstanceUploadVersion = Internal::GetChangeVersion();
+
+    // 1. Changed Instances (all of a mesh when the component was marked, or its stamps are out of step), as load indices
+    std::vector<size_t> changed;
+    std::vector<size_t> changedMeshes;
+    bool meshChanged = false;
+    for (size_t i = 0; i < meshPool.m_Data.size(); ++i) {
+      const MeshComponent& meshComponent = meshPool.m_Data[i];
+      const size_t start = meshComponent.instanceStartIndex;
+      const size_t count = meshComponent.instanceTransforms.size();
+      const bool wholeMesh = meshPool.m_Versions[i] > since || meshComponent.instanceVersions.size() != count;
+      meshChanged |= meshPool.m_Versions[i] > since;
+
+      for (size_t k = 0; k < count; ++k) {
+        if (wholeMesh || meshComponent.instanceVersions[k] > since) {
+          changed.push_back(start + k);
+          changedMeshes.push_back(i);
+        }
+      }
+    }
+
+    // A marked component may also carry new geometry
+    if (meshChanged && HasContext()) UploadSceneGeometry(universe);
+
+    if (changed.empty()) return;
+
+    // 2. CPU device: the caches are the simulation data (compaction may have moved or removed the instance)
+    if (m_SimulationDevice == CPUDevice || !HasContext()) {
+      std::vector<size_t> written;
+      for (size_t u = 0; u < changed.size(); ++u) {
+        const size_t instance = m_LoadedInstances[changed[u]];
+        if (instance == INVALID_INSTANCE) continue;
+
+        const MeshComponent& meshComponent = meshPool.m_Data[changedMeshes[u]];
+        const size_t local = changed[u] - meshComponent.instanceStartIndex;
+
+        m_InstanceTransforms[instance] = meshComponent.instanceTransforms[local];
+        m_InstanceMotions[instance] = meshComponent.instanceMotions[local];
+        m_InstanceMaterials[instance] = meshComponent.instanceMaterials[local];
+        written.push_back(instance);
+      }
+
+      InvalidateGrid();
+
+      // Transforms and motions reach the GPU with the per-frame upload in DrawScene, materials only here
+      if (!HasContext() || written.empty()) return;
+
+      std::sort(written.begin(), written.end());
+      ForEachRun(written, [&](size_t first, size_t count) {
+        Resources::UpdateShaderStorageBufferObject<Material>(m_InstanceMaterials.data() + first, count, first, m_BufferObjects["InstanceMaterial"]);
+        m_UploadedBytes += count * sizeof(Material);
+      });
+      return;
+    }
+
+    // Pending grid results go back first, the changed instances then overwrite them
+    ScatterGrid();
+    InvalidateGrid();
+
+    if (!m_ShaderPrograms.contains("InstanceUpdate")) {
+      m_ShaderPrograms["InstanceUpdate"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]InstanceUpdate.comp");
+    }
+
+    // 3. GPU device: changed instances go straight into the upload ring, the shader finds their current slots
+    const size_t updateBytes = changed.size() * sizeof(InstanceUpdate);
+    InstanceUpdate* updates = reinterpret_cast<InstanceUpdate*>(MapUploadRegion(updateBytes));
+
+    for (size_t u = 0; u < changed.size(); ++u) {
+      const MeshComponent& meshComponent = meshPool.m_Data[changedMeshes[u]];
+      const size_t local = changed[u] - meshComponent.instanceStartIndex;
+
+      updates[u].transform = meshComponent.instanceTransforms[local];
+      updates[u].motion = meshComponent.instanceMotions[local];
+      updates[u].material = meshComponent.instanceMaterials[local];
+      updates[u].instanceIndex = changed[u];
+    }
+
+    SubmitUploadRegion({}, [&](BufferID ring, size_t offset) {
+      glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 32, ring, offset, updateBytes);
+
+      Resources::UseProgram(m_ShaderPrograms["InstanceUpdate"]);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["InstanceUpdate"], "numUpdates", changed.size());
+      glDispatchCompute((changed.size() + 63) / 64, 1, 1);
+      glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    });
+  }
+
+  unsigned char* Engine::MapUploadRegion(size_t size) {
+    m_UploadedBytes += size;
+
+    const size_t alignedSize = std::max(UPLOAD_ALIGNMENT, (size + UPLOAD_ALIGNMENT - 1) & ~(UPLOAD_ALIGNMENT - 1));
+    m_UploadFrameBytes += alignedSize;
+
+    // 1. Grow (a single upload larger than a region)
+    if (size > m_UploadRegionSize) ResizeUploadRing(std::bit_ceil(std::max<size_t>(size, 1 << 16)));
+
+    // 2. Overflow (this frame outgrew its region, continue in the next one until the frame boundary grows the ring)
+    if (m_UploadOffset + alignedSize > m_UploadRegionSize) RotateUploadRegion();
+
+    // 3. Wait once per region for the GPU to finish with it (three frames ago)
+    if (!m_UploadRegionAcquired) {
+      GLsync& fence = m_UploadFences[m_UploadRegion];
+      if (fence) {
+        if (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED) == GL_WAIT_FAILED) {
+          throw EngineException("Upload ring fence wait failed");
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+      }
+      m_UploadRegionAcquired = true;
+    }
+
+    // 4. Sub-allocate (aligned, so shaders can bind the upload in place)
+    m_UploadCursor = m_UploadOffset;
+    m_UploadOffset += alignedSize;
+
+    const size_t offset = m_UploadRegion * m_UploadRegionSize + m_UploadCursor;
+    if (m_UploadRingData) return m_UploadRingData + offset;
+
+    // Without GL 4.4 each upload is mapped unsynchronized (the region fence already guards it)
+    glBindBuffer(GL_COPY_READ_BUFFER, m_BufferObjects["UploadRing"]);
+    return (unsigned char*)glMapBufferRange(GL_COPY_READ_BUFFER, offset, alignedSize,
+      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+  }
+
+  void Engine::SubmitUploadRegion(const std::vector<std::pair<std::string, size_t>>& targets,
+    const std::function<void(BufferID ring, size_t offset)>& consume) {
+    if (!m_UploadRingData) {
+      glBindBuffer(GL_COPY_READ_BUFFER, m_BufferObjects["UploadRing"]);
+      glUnmapBuffer(GL_COPY_READ_BUFFER);
+    }
+
+    // Targets were written back to back from the start of the upload
+    const size_t uploadOffset = m_UploadRegion * m_UploadRegionSize + m_UploadCursor;
+    size_t offset = uploadOffset;
+    for (const auto& [name, size] : targets) {
+      if (size > 0) Resources::CopyBufferObject(m_BufferObjects["UploadRing"], m_BufferObjects[name], size, offset, 0);
+      offset += size;
+    }
+
+    // Shaders may also read the upload in place
+    if (consume) consume(m_BufferObjects["UploadRing"], uploadOffset);
+  }
+
+  void Engine::ResizeUploadRing(size_t regionSize) {
+    // Waits for every region still in flight (commands already issued keep the old buffer alive)
+    for (GLsync& fence : m_UploadFences) {
+      if (fence) {
+        glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        glDeleteSync(fence);
+        fence = nullptr;
+      }
+    }
+
+    if (m_BufferObjects.contains("UploadRing")) glDeleteBuffers(1, &m_BufferObjects["UploadRing"]);
+    m_BufferObjects["UploadRing"] = Resources::CreateBuffer();
+    m_UploadRegionSize = regionSize;
+    m_UploadRingData = nullptr;
+    m_UploadRegion = 0;
+    m_UploadRegionAcquired = false;
+    m_UploadOffset = 0;
+
+    glBindBuffer(GL_COPY_READ_BUFFER, m_BufferObjects["UploadRing"]);
+    if (glBufferStorage) {
+      // Mapped once for the lifetime of the ring
+      const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+      glBufferStorage(GL_COPY_READ_BUFFER, UPLOAD_RING_FRAMES * m_UploadRegionSize, nullptr, flags);
+      m_UploadRingData = (unsigned char*)glMapBufferRange(GL_COPY_READ_BUFFER, 0, UPLOAD_RING_FRAMES * m_UploadRegionSize, flags);
+    } else {
+      glBufferData(GL_COPY_READ_BUFFER, UPLOAD_RING_FRAMES * m_UploadRegionSize, nullptr, GL_STREAM_DRAW);
+    }
+  }
+
+  void Engine::RotateUploadRegion() {
+    // Fences everything issued against the region so far, a region nothing was written to needs none
+    if (m_UploadRegionAcquired) {
+      m_UploadFences[m_UploadRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      m_UploadRegion = (m_UploadRegion + 1) % UPLOAD_RING_FRAMES;
+      m_UploadRegionAcquired = false;
+    }
+    m_UploadOffset = 0;
+  }
+
+  void Engine::EndUploadFrame() {
+    RotateUploadRegion();
+
+    // A frame that overflowed its region gets a ring it fits in from now on
+    if (m_UploadFrameBytes > m_UploadRegionSize) ResizeUploadRing(std::bit_ceil(m_UploadFrameBytes));
+    m_UploadFrameBytes = 0;
+  }
+
+  void Engine::UploadSceneGeometry(Universe& universe) {
+    auto& meshPool = universe.GetPool<MeshComponent>();
+
+    // Impostor quad first (corners in [-1, 1], expanded per instance by Impostor.vert)
+    std::vector<Vertex> vertices = {
+      {{-1.0, -1.0, 0.0}, {0.0, 0.0, 1.0}, {0.0, 0.0}},
+      {{ 1.0, -1.0, 0.0}, {0.0, 0.0, 1.0}, {1.0, 0.0}},
+      {{ 1.0,  1.0, 0.0}, {0.0, 0.0, 1.0}, {1.0, 1.0}},
+      {{-1.0,  1.0, 0.0}, {0.0, 0.0, 1.0}, {0.0, 1.0}}
+    };
+    std::vector<unsigned int> indices = {0, 1, 2, 2, 3, 0};
+
+    std::vector<MeshDraw> meshDraws(meshPool.m_Data.size());
+    std::vector<DrawElementsIndirectCommand> drawCommands;
+    std::vector<DrawElementsIndirectCommand> impostorCommands;
+
+    // 1. Command Order (spheres last, so impostors draw them as one separate range)
+    std::vector<size_t> commandOrder;
+    for (size_t i = 0; i < meshPool.m_Data.size(); ++i) {
+      if (meshPool.m_Data[i].mesh.sphereRadius <= 0.0f) commandOrder.push_back(i);
+    }
+    m_SceneSphereCount = meshPool.m_Data.size() - commandOrder.size();
+    for (size_t i = 0; i < meshPool.m_Data.size(); ++i) {
+      if (meshPool.m_Data[i].mesh.sphereRadius > 0.0f) commandOrder.push_back(i);
+    }
+
+    // Visible slots of a mesh: room for its own instances and everything its emitter may add
+    std::vector<unsigned int> visibleStarts(meshPool.m_Data.size(), 0);
+    for (size_t i = 1; i < visibleStarts.size(); ++i) {
+      visibleStarts[i] = visibleStarts[i - 1] + m_MeshInstanceCapacities[i - 1];
+    }
+
+    // 2. Merge Meshes
+    for (unsigned int command = 0; command < commandOrder.size(); ++command) {
+      const MeshComponent& meshComponent = meshPool.m_Data[commandOrder[command]];
+      const Mesh& mesh = meshComponent.mesh;
+
+      // Bounding sphere around the mesh origin (scaled per instance while culling)
+      float boundingRadius = mesh.sphereRadius;
+      for (const Vertex& vertex : mesh.vertices) {
+        boundingRadius = std::max(boundingRadius, glm::length(vertex.position));
+      }
+
+      MeshDraw meshDraw;
+      meshDraw.indexCount = mesh.indices.size();
+      meshDraw.firstIndex = indices.size();
+      meshDraw.baseVertex = vertices.size();
+      meshDraw.instanceStart = visibleStarts[commandOrder[command]];
+      meshDraw.boundingRadius = boundingRadius;
+      meshDraw.commandIndex = command;
+      meshDraws[commandOrder[command]] = meshDraw;
+
+      // Culling fills in instanceCount every frame, baseInstance points at the mesh's visible slots
+      drawCommands.push_back({ meshDraw.indexCount, 0, meshDraw.firstIndex, meshDraw.baseVertex, meshDraw.instanceStart });
+
+      if (mesh.sphereRadius > 0.0f) {
+        impostorCommands.push_back({ 6, 0, 0, 0, meshDraw.instanceStart });
+      } else {
+        impostorCommands.push_back(drawCommands.back());
+      }
+
+      vertices.insert(vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+      indices.insert(indices.end(), mesh.indices.begin(), mesh.indices.end());
+    }
+
+    m_SceneMeshCount = meshDraws.size();
+
+    if (m_SceneVAO == 0) {
+      m_SceneVAO = Resources::CreateVertexArrayObject();
+      m_BufferObjects["SceneVertex"] = Resources::CreateBuffer();
+      m_BufferObjects["SceneIndex"] = Resources::CreateBuffer();
+      m_BufferObjects["VisibleInstance"] = Resources::CreateBuffer();
+      m_BufferObjects["MeshDraw"] = Resources::CreateBuffer();
+      m_BufferObjects["DrawCommand"] = Resources::CreateBuffer();
+      m_BufferObjects["DrawCommandReset"] = Resources::CreateBuffer();
+      m_BufferObjects["ImpostorCommandReset"] = Resources::CreateBuffer();
+    }
+
+    m_UploadedBytes += vertices.size() * sizeof(Vertex) + indices.size() * sizeof(unsigned int)
+      + meshDraws.size() * sizeof(MeshDraw) + 2 * drawCommands.size() * sizeof(DrawElementsIndirectCommand);
+
+    // 3. Vertex Layout (reallocated, a reload may add meshes)
+    Resources::BindVertexArrayObject(m_SceneVAO);
+    Resources::UploadVertexBufferObject(vertices, m_BufferObjects["SceneVertex"]);
+    Resources::UploadElementBufferObject(indices, m_BufferObjects["SceneIndex"]);
+
+    // Position
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+
+    // Normal
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+
+    // TexCoords
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
+
+    // Visible Slot (one per instance of the capacity, offset per mesh by baseInstance)
+    Resources::AllocateShaderStorageBufferObject(std::max<size_t>(m_InstanceCapacity, 1) * sizeof(unsigned int), m_BufferObjects["VisibleInstance"]);
+    glBindBuffer(GL_ARRAY_BUFFER, m_BufferObjects["VisibleInstance"]);
+    glEnableVertexAttribArray(3);
+    glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(unsigned int), (void*)0);
+    glVertexAttribDivisor(3, 1);
+
+    Resources::UnbindVertexArrayObject();
+
+    // 4. Draw Records
+    Resources::UploadShaderStorageBufferObject<MeshDraw>(meshDraws, m_BufferObjects["MeshDraw"]);
+    Resources::UploadShaderStorageBufferObject<DrawElementsIndirectCommand>(drawCommands, m_BufferObjects["DrawCommand"]);
+    Resources::UploadShaderStorageBufferObject<DrawElementsIndirectCommand>(drawCommands, m_BufferObjects["DrawCommandReset"]);
+    Resources::UploadShaderStorageBufferObject<DrawElementsIndirectCommand>(impostorCommands, m_BufferObjects["ImpostorCommandReset"]);
+
+    Resources::BindShaderStorageToLocation(29, m_BufferObjects["VisibleInstance"]);
+    Resources::BindShaderStorageToLocation(30, m_BufferObjects["MeshDraw"]);
+    Resources::BindShaderStorageToLocation(31, m_BufferObjects["DrawCommand"]);
+  }
+
+  void Engine::DownloadInstanceBuffers() {
+    ScatterGrid();
+
+    const size_t numInstances = m_InstanceCount;
+    std::vector<Transform> slotTransforms(numInstances);
+    std::vector<Motion> slotMotions(numInstances);
+    std::vector<Material> slotMaterials(numInstances);
+    std::vector<unsigned int> slotEntityIndices(numInstances);
+    std::vector<unsigned int> slotAlive(numInstances);
+    std::vector<unsigned int> instanceSlots(numInstances);
+    Resources::DownloadShaderStorageBufferObject<Transform>(slotTransforms, m_BufferObjects["InstanceTransform"]);
+    Resources::DownloadShaderStorageBufferObject<Motion>(slotMotions, m_BufferObjects["InstanceMotion"]);
+    Resources::DownloadShaderStorageBufferObject<Material>(slotMaterials, m_BufferObjects["InstanceMaterial"]);
+    Resources::DownloadShaderStorageBufferObject<unsigned int>(slotEntityIndices, m_BufferObjects["InstanceToEntityIndex"]);
+    Resources::DownloadShaderStorageBufferObject<unsigned int>(slotAlive, m_BufferObjects["InstanceAlive"]);
+    Resources::DownloadShaderStorageBufferObject<unsigned int>(instanceSlots, m_BufferObjects["InstanceSlot"]);
+
+    // Where each loaded instance went (only compaction on the GPU changes it)
+    m_LoadedInstances.resize(std::accumulate(m_MeshInstanceCounts.begin(), m_MeshInstanceCounts.end(), size_t(0)));
+    Resources::DownloadShaderStorageBufferObject<unsigned int>(m_LoadedInstances, m_BufferObjects["LoadedInstance"]);
+
+    // Back to submission order (materials and entity indices only exist on the GPU for emitted instances)
+    m_InstanceTransforms.resize(numInstances);
+    m_InstanceMotions.resize(numInstances);
+    m_InstanceMaterials.resize(numInstances);
+    m_InstanceToEntityIndex.resize(numInstances);
+    m_InstanceAlive.resize(numInstances);
+
+    for (size_t i = 0; i < numInstances; ++i) {
+      m_InstanceTransforms[i] = slotTransforms[instanceSlots[i]];
+      m_InstanceMotions[i] = slotMotions[instanceSlots[i]];
+      m_InstanceMaterials[i] = slotMaterials[instanceSlots[i]];
+      m_InstanceToEntityIndex[i] = slotEntityIndices[instanceSlots[i]];
+      m_InstanceAlive[i] = slotAlive[instanceSlots[i]];
+    }
+  }
 
-      const BoundingComponent* boundingComponent = boundingPool.Get(entityID);
-      bounds.push_back(boundingComponent->bound);
+  unsigned int Engine::RequestReadback(size_t first, size_t count, bool mirror) {
+    PendingReadback readback;
+    readback.id = m_NextReadbackID++;
+    readback.mirror = mirror;
+
+    // Clamped to the live instances, or to the loaded ones in load order
+    const size_t total = mirror ? m_LoadedInstances.size() : m_InstanceCount;
+    readback.first = std::min(first, total);
+    readback.count = std::min(count, total - readback.first);
+
+    // 1. CPU device: the caches are the simulation data, ready right away
+    if (m_SimulationDevice == CPUDevice || !HasContext() || readback.count == 0) {
+      readback.records.resize(readback.count);
+      for (size_t i = 0; i < readback.count; ++i) {
+        ReadbackRecord& record = readback.records[i];
+        record.instanceIndex = mirror ? m_LoadedInstances[readback.first + i] : readback.first + i;
+        if (record.instanceIndex == INVALID_INSTANCE) continue;
+
+        record.transform = m_InstanceTransforms[record.instanceIndex];
+        record.motion = m_InstanceMotions[record.instanceIndex];
+      }
+
+      m_Readbacks.push_back(std::move(readback));
+      return m_Readbacks.back().id;
     }
 
-    if (!m_BufferObjects.contains("EntityBound")) {
-      m_BufferObjects["EntityBound"] = Resources::CreateBuffer();
-      // Allocate once
-      Resources::UploadShaderStorageBufferObject<Bound>(bounds, m_BufferObjects["EntityBound"]);
-      Resources::BindShaderStorageToLocation(4, m_BufferObjects["EntityBound"]);
-    } else {
-      Resources::UpdateShaderStorageBufferObject<Bound>(bounds, m_BufferObjects["EntityBound"]);
+    if (!m_ShaderPrograms.contains("Readback")) {
+      m_ShaderPrograms["Readback"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]Readback.comp");
     }
-  }
 
-  void Engine::LoadFluidBuffers(Universe &universe) {
+    // Pending grid writes land first
+    ScatterGrid();
 
-    auto& meshPool = universe.GetPool<MeshComponent>();
-    auto& fluidPool = universe.GetPool<FluidComponent>();
+    // 2. Gather the range from its current slots straight into a staging buffer
+    readback.staging = AcquireReadbackStaging(readback.count * sizeof(ReadbackRecord));
+    Resources::BindShaderStorageToLocation(40, readback.staging.buffer);
 
-    std::vector<FluidMaterial> fluids;
+    Resources::UseProgram(m_ShaderPrograms["Readback"]);
+    Resources::SetUniformUnsignedInt(m_ShaderPrograms["Readback"], "first", readback.first);
+    Resources::SetUniformUnsignedInt(m_ShaderPrograms["Readback"], "count", readback.count);
+    Resources::SetUniformUnsignedInt(m_ShaderPrograms["Readback"], "useLoadOrder", mirror ? 1 : 0);
+    glDispatchCompute((readback.count + 63) / 64, 1, 1);
 
-    // Loop through each mesh
-    for(size_t i = 0; i < meshPool.m_Data.size(); ++i) {
-      MeshComponent& meshComponent = meshPool.m_Data[i];
-      const EntityID entityID = meshPool.m_IndexToEntity[i];
+    // 3. Fence (the writes must reach the client mapping, or a later glMapBufferRange without one, before it signals)
+    glMemoryBarrier(GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+    readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
 
-      const FluidComponent* fluidComponent = fluidPool.Get(entityID);
-      fluids.push_back(fluidComponent->fluidMaterial);
+    m_Readbacks.push_back(std::move(readback));
+    return m_Readbacks.back().id;
+  }
+
+  Engine::ReadbackStaging Engine::AcquireReadbackStaging(size_t size) {
+    // A collected one that is large enough, or a new one mapped once for its lifetime
+    auto free = std::find_if(m_FreeReadbackStaging.begin(), m_FreeReadbackStaging.end(),
+      [&](const ReadbackStaging& staging) { return staging.size >= size; });
+
+    if (free != m_FreeReadbackStaging.end()) {
+      ReadbackStaging staging = *free;
+      m_FreeReadbackStaging.erase(free);
+      return staging;
     }
 
-    if (!m_BufferObjects.contains("EntityFluidMaterial")) {
-      m_BufferObjects["EntityFluidMaterial"] = Resources::CreateBuffer();
-      // Allocate once
-      Resources::UploadShaderStorageBufferObject<FluidMaterial>(fluids, m_BufferObjects["EntityFluidMaterial"]);
-      Resources::BindShaderStorageToLocation(13, m_BufferObjects["EntityFluidMaterial"]);
+    ReadbackStaging staging;
+    staging.buffer = Resources::CreateBuffer();
+    staging.size = std::bit_ceil(std::max<size_t>(size, 1 << 12));
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, staging.buffer);
+    if (glBufferStorage) {
+      const GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+      glBufferStorage(GL_COPY_WRITE_BUFFER, staging.size, nullptr, flags);
+      staging.data = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, staging.size, flags);
     } else {
-      Resources::UpdateShaderStorageBufferObject<FluidMaterial>(fluids, m_BufferObjects["EntityFluidMaterial"]);
+      glBufferData(GL_COPY_WRITE_BUFFER, staging.size, nullptr, GL_STREAM_READ);
     }
-  }
 
-  void Engine::LoadGridBuffers() {
+    return staging;
+  }
 
-    // Calculate Next Power of Two for Bitonic Sort
-    size_t sortedSize = 1;
-    while(sortedSize < m_InstanceTransforms.size()) sortedSize <<= 1;
+  void Engine::ReadReadbackStaging(const ReadbackStaging& staging, void* destination, size_t size) {
+    if (size == 0) return;
 
-    // Spatial Hash Table Size (Fixed)
-    const unsigned int hashTableSize = 1 << 21;
+    // Only called once the fence has passed, so neither path stalls
+    if (staging.data) {
+      std::memcpy(destination, staging.data, size);
+      return;
+    }
 
-    // Allocate fixed size hash table
-    std::vector<int> emptyGrid(hashTableSize, -1);
-    std::vector<GridPair> pairs(sortedSize, { 0xFFFFFFFF, 0xFFFFFFFF });
+    glBindBuffer(GL_COPY_WRITE_BUFFER, staging.buffer);
+    std::memcpy(destination, glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, GL_MAP_READ_BIT), size);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+  }
 
-    // 3. Initialize Buffers
-    if (!m_BufferObjects.contains("GridHead")) {
-      m_BufferObjects["GridHead"] = Resources::CreateBuffer();
-      m_BufferObjects["GridPair"] = Resources::CreateBuffer();
-      m_BufferObjects["SortedTransform"] = Resources::CreateBuffer();
-      m_BufferObjects["SortedMotion"] = Resources::CreateBuffer();
+  bool Engine::PollReadbackFence(GLsync& fence) {
+    if (!fence) return true;
 
-      Resources::UploadShaderStorageBufferObject<int>(emptyGrid, m_BufferObjects["GridHead"]);
-      Resources::UploadShaderStorageBufferObject<GridPair>(pairs, m_BufferObjects["GridPair"]);
-      Resources::UploadShaderStorageBufferObject<Transform>(m_InstanceTransforms, m_BufferObjects["SortedTransform"]);
-      Resources::UploadShaderStorageBufferObject<Motion>(m_InstanceMotions, m_BufferObjects["SortedMotion"]);
+    // Polls only (zero timeout), the flush makes sure the fence is submitted at all
+    const GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    if (status == GL_TIMEOUT_EXPIRED) return false;
+    if (status == GL_WAIT_FAILED) throw EngineException("Readback fence wait failed");
 
-      Resources::BindShaderStorageToLocation(9, m_BufferObjects["GridHead"]);
-      Resources::BindShaderStorageToLocation(10, m_BufferObjects["GridPair"]);
-      Resources::BindShaderStorageToLocation(11, m_BufferObjects["SortedTransform"]);
-      Resources::BindShaderStorageToLocation(12, m_BufferObjects["SortedMotion"]);
-    } else {
-      Resources::UpdateShaderStorageBufferObject<int>(emptyGrid, m_BufferObjects["GridHead"]);
-      Resources::UpdateShaderStorageBufferObject<GridPair>(pairs,m_BufferObjects["GridPair"]);
-      Resources::UpdateShaderStorageBufferObject<Transform>(m_InstanceTransforms, m_BufferObjects["SortedTransform"]);
-      Resources::UpdateShaderStorageBufferObject<Motion>(m_InstanceMotions, m_BufferObjects["SortedMotion"]);
-    }
+    glDeleteSync(fence);
+    fence = nullptr;
+    return true;
   }
 
-  void Engine::EnableMotion(float deltaTime) {
-    if (m_InstanceMotions.empty()) return;
+  bool Engine::CollectReadback(PendingReadback& readback) {
+    if (!PollReadbackFence(readback.fence)) return false;
+    if (!readback.staging.buffer) return true;
 
-    if (!m_ShaderPrograms.contains("Motion")) {
-      m_ShaderPrograms["Motion"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]Motion.comp");
-    }
+    readback.records.resize(readback.count);
+    ReadReadbackStaging(readback.staging, readback.records.data(), readback.count * sizeof(ReadbackRecord));
+
+    m_FreeReadbackStaging.push_back(readback.staging);
+    readback.staging = {};
+    return true;
+  }
 
-    GLuint groups = (m_InstanceMotions.size() + 63) / 64;
+  bool Engine::TryGetReadback(unsigned int readback, std::vector<ReadbackRecord>& records) {
+    auto pending = std::find_if(m_Readbacks.begin(), m_Readbacks.end(),
+      [&](const PendingReadback& request) { return request.id == readback; });
+    if (pending == m_Readbacks.end()) throw EngineException("Unknown readback " + std::to_string(readback));
 
-    Resources::UseProgram(m_ShaderPrograms["Motion"]);
-    Resources::SetUniformFloat(m_ShaderPrograms["Motion"], "deltaTime", deltaTime);
+    if (!CollectReadback(*pending)) return false;
 
-    glDispatchCompute(groups, 1, 1);
-    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    records = std::move(pending->records);
+    m_Readbacks.erase(pending);
+    return true;
   }
 
-  void Engine::EnableGravity(float globalGravity) {
-    if (m_InstanceMotions.empty()) return;
+  void Engine::MirrorReadbacks(Universe& universe) {
+    auto& meshPool = universe.GetPool<MeshComponent>();
 
-    if (!m_ShaderPrograms.contains("Gravity")) {
-      m_ShaderPrograms["Gravity"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]GlobalGravity.comp");
-    }
+    for (auto readback = m_Readbacks.begin(); readback != m_Readbacks.end();) {
+      if (!readback->mirror || !CollectReadback(*readback)) {
+        ++readback;
+        continue;
+      }
 
-    GLuint groups = (m_InstanceMotions.size() + 63) / 64;
+      // Load order is each mesh's instances back to back, so the range overlaps a run of meshes
+      const size_t first = readback->first;
+      const size_t last = first + readback->count;
+      for (MeshComponent& meshComponent : meshPool.m_Data) {
+        const size_t start = std::max<size_t>(meshComponent.instanceStartIndex, first);
+        const size_t end = std::min<size_t>(meshComponent.instanceStartIndex + meshComponent.instanceTransforms.size(), last);
 
-    Resources::UseProgram( m_ShaderPrograms["Gravity"]);
-    Resources::SetUniformFloat( m_ShaderPrograms["Gravity"], "globalGravity", globalGravity);
+        for (size_t k = start; k < end; ++k) {
+          const ReadbackRecord& record = readback->records[k - first];
+          if (record.instanceIndex == INVALID_INSTANCE) continue;
 
-    glDispatchCompute(groups, 1, 1);
-    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+          const size_t local = k - meshComponent.instanceStartIndex;
+          meshComponent.instanceTransforms[local] = record.transform;
+          meshComponent.instanceMotions[local] = record.motion;
+        }
+      }
+
+      readback = m_Readbacks.erase(readback);
+    }
   }
-  
-  void Engine::BuildGrid(float globalBounds, float cellSize) {
-    if (m_InstanceTransforms.empty()) return;
 
-    // 1. Initialize Shaders
-    if (!m_ShaderPrograms.contains("GridBuild")) {
-      m_ShaderPrograms["GridClear"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]GridClear.comp");
-      m_ShaderPrograms["GridBuild"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]GridBuild.comp");
+  unsigned int Engine::RequestSpatialQueries(const std::vector<SpatialQuery>& queries, float globalBounds, float cellSize) {
+    PendingSpatialQueries pending;
+    pending.id = m_NextReadbackID++;
+    pending.queryCount = queries.size();
 
-      m_ShaderPrograms["BitonicSort"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]BitonicSort.comp");
-      m_ShaderPrograms["GridOffset"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]GridOffsets.comp");
-      m_ShaderPrograms["GridReorder"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]GridReorder.comp");
-      m_ShaderPrograms["GridScatter"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]GridScatter.comp");
+    if (queries.empty() || m_InstanceCount == 0) {
+      pending.results.ranges.assign(queries.size(), {0, 0});
+      m_SpatialQueries.push_back(std::move(pending));
+      return m_SpatialQueries.back().id;
     }
 
-    size_t numInstances = m_InstanceTransforms.size();
-
-    size_t sortedSize = 1;
-    while(sortedSize < numInstances) sortedSize <<= 1;
+    // Reused while nothing has moved since the last grid system
+    BuildGrid(globalBounds, cellSize);
 
-    // Spatial Hash Table Size (Fixed)
-    const unsigned int hashTableSize = 1 << 21;
+    // 1. CPU device: the grid snapshot answers right away
+    if (m_SimulationDevice == CPUDevice) {
+      GetCPUPhysics().SpatialQueries(queries, pending.results);
+      m_SpatialQueries.push_back(std::move(pending));
+      return m_SpatialQueries.back().id;
+    }
 
-    GLuint groups = (numInstances + 63) / 64;
-    GLuint setSizeGroups = (sortedSize + 63) / 64;
+    if (!m_ShaderPrograms.contains("SpatialQuery")) {
+      m_ShaderPrograms["SpatialQuery"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]SpatialQuery.comp");
+    }
 
-    // 1. Clear Grid (Head)
-    Resources::UseProgram(m_ShaderPrograms["GridClear"]);
-    Resources::SetUniformInt(m_ShaderPrograms["GridClear"], "totalCells", hashTableSize);
-    glDispatchCompute((hashTableSize + 63) / 64, 1, 1);
-    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    // 2. Staging (each query's cap bounds its hits, they are compacted by one atomic counter)
+    size_t hitCapacity = 0;
+    for (const SpatialQuery& query : queries) {
+      if (query.type == QueryRaycast) hitCapacity += 1;
+      else if (query.type == QueryKNearest) hitCapacity += std::min(query.maxResults, 16u);
+      else hitCapacity += query.maxResults;
+    }
 
+    pending.rangeStaging = AcquireReadbackStaging(queries.size() * sizeof(SpatialQueryRange));
+    pending.hitStaging = AcquireReadbackStaging(std::max<size_t>(hitCapacity, 1) * sizeof(SpatialHit));
+    Resources::BindShaderStorageToLocation(42, pending.rangeStaging.buffer);
+    Resources::BindShaderStorageToLocation(43, pending.hitStaging.buffer);
+
+    const unsigned int hitCount = 0;
+    ReserveShaderStorageBuffer("SpatialHitCounter", sizeof(unsigned int));
+    Resources::UpdateShaderStorageBufferObject<unsigned int>(&hitCount, 1, 0, m_BufferObjects["SpatialHitCounter"]);
+    Resources::BindShaderStorageToLocation(44, m_BufferObjects["SpatialHitCounter"]);
+
+    // 3. Query (one thread per query, the queries are read in place from the upload ring)
+    const size_t queryBytes = queries.size() * sizeof(SpatialQuery);
+    std::memcpy(MapUploadRegion(queryBytes), queries.data(), queryBytes);
+
+    SubmitUploadRegion({}, [&](BufferID ring, size_t offset) {
+      glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 41, ring, offset, queryBytes);
+
+      Resources::UseProgram(m_ShaderPrograms["SpatialQuery"]);
+      Resources::SetUniformFloat(m_ShaderPrograms["SpatialQuery"], "globalBounds", globalBounds);
+      Resources::SetUniformFloat(m_ShaderPrograms["SpatialQuery"], "cellSize", cellSize);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["SpatialQuery"], "hashTableSize", m_GridTableSize);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["SpatialQuery"], "gridMode", m_GridBuildMode);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["SpatialQuery"], "numQueries", queries.size());
+      glDispatchCompute((queries.size() + 63) / 64, 1, 1);
+    });
+
+    // 4. Fence (the writes must reach the client mapping, or a later glMapBufferRange without one, before it signals)
+    glMemoryBarrier(GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+    pending.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    m_SpatialQueries.push_back(std::move(pending));
+    return m_SpatialQueries.back().id;
+  }
 
-    // 2. Build Key-Value Pairs
-    Resources::UseProgram(m_ShaderPrograms["GridBuild"]);
-    Resources::SetUniformFloat(m_ShaderPrograms["GridBuild"], "globalBounds", globalBounds);
-    Resources::SetUniformFloat(m_ShaderPrograms["GridBuild"], "cellSize", cellSize);
-    Resources::SetUniformUnsignedInt(m_ShaderPrograms["GridBuild"], "hashTableSize", hashTableSize); // Hash Table Size
-    Resources::SetUniformUnsignedInt(m_ShaderPrograms["GridBuild"], "numInstances", numInstances);
-    glDispatchCompute(groups, 1, 1);
-    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+  bool Engine::CollectSpatialQueries(PendingSpatialQueries& queries) {
+    if (!PollReadbackFence(queries.fence)) return false;
+    if (!queries.rangeStaging.buffer) return true;
 
+    // Ranges first, they tell how much of the hit staging was used
+    SpatialQueryResults& results = queries.results;
+    results.ranges.resize(queries.queryCount);
+    ReadReadbackStaging(queries.rangeStaging, results.ranges.data(), queries.queryCount * sizeof(SpatialQueryRange));
 
-    // 3. Bitonic Sort (Iterative Dispatch)
-    Resources::UseProgram(m_ShaderPrograms["BitonicSort"]);
-    // k = block width (2, 4, 8, ... N)
-    // j = comparison distance (k/2, k/4, ... 1)
-    for (unsigned int k = 2; k <= sortedSize; k <<= 1) {
-      for (unsigned int j = k >> 1; j > 0; j >>= 1) {
-        Resources::SetUniformUnsignedInt(m_ShaderPrograms["BitonicSort"], "j", j);
-        Resources::SetUniformUnsignedInt(m_ShaderPrograms["BitonicSort"], "k", k);
-        glDispatchCompute(setSizeGroups, 1, 1);
-        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
-      }
-    }
+    size_t hitCount = 0;
+    for (const SpatialQueryRange& range : results.ranges) hitCount += range.count;
 
+    results.hits.resize(hitCount);
+    ReadReadbackStaging(queries.hitStaging, results.hits.data(), hitCount * sizeof(SpatialHit));
 
-    // 4. Find Offsets (Populate GridHead)
-    Resources::UseProgram(m_ShaderPrograms["GridOffset"]);
-    Resources::SetUniformUnsignedInt(m_ShaderPrograms["GridOffset"], "numInstances", numInstances);
-    glDispatchCompute(groups, 1, 1);
-    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    m_FreeReadbackStaging.push_back(queries.rangeStaging);
+    m_FreeReadbackStaging.push_back(queries.hitStaging);
+    queries.rangeStaging = {};
+    queries.hitStaging = {};
+    return true;
+  }
 
+  bool Engine::TryGetSpatialQueries(unsigned int queries, SpatialQueryResults& results) {
+    auto pending = std::find_if(m_SpatialQueries.begin(), m_SpatialQueries.end(),
+      [&](const PendingSpatialQueries& request) { return request.id == queries; });
+    if (pending == m_SpatialQueries.end()) throw EngineException("Unknown spatial query batch " + std::to_string(queries));
 
-    // 5. Reorder (Gather)
-    Resources::UseProgram(m_ShaderPrograms["GridReorder"]);
-    Resources::SetUniformUnsignedInt(m_ShaderPrograms["GridReorder"], "numInstances", numInstances);
-    glDispatchCompute(groups, 1, 1);
-    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    if (!CollectSpatialQueries(*pending)) return false;
 
+    results = std::move(pending->results);
+    m_SpatialQueries.erase(pending);
+    return true;
   }
 
   void Engine::EnableSPHFluid(float globalBounds, float cellSize) {
-    if (m_InstanceTransforms.empty()) return;
+    if (m_InstanceCount == 0) return;
+
+    if (m_SimulationDevice == CPUDevice) {
+      if (m_EntityFluidMaterials.empty()) throw EngineException("LoadFluidBuffers must be called before EnableSPHFluid");
+
+      BuildGrid(globalBounds, cellSize);
+      GetCPUPhysics().EnableSPHFluid(m_InstanceMotions, m_InstanceToEntityIndex, m_EntityFluidMaterials);
+      return;
+    }
 
     // 1. Initialize Shaders
     if (!m_ShaderPrograms.contains("SPHFluidDensity")) {
@@ -337,16 +1884,61 @@ namespace Spade {
     }
 
     BuildGrid(globalBounds, cellSize);
-    const unsigned int hashTableSize = 1 << 21;
+    const unsigned int hashTableSize = m_GridTableSize;
 
-    size_t numInstances = m_InstanceTransforms.size();
+    size_t numInstances = m_InstanceCount;
     GLuint groups = (numInstances + 63) / 64;
 
+    if (m_FluidKernel == FusedFluidKernel) {
+      if (!m_ShaderPrograms.contains("SPHFluidDensityFused")) {
+        m_ShaderPrograms["SPHFluidDensityFused"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]FluidDensityFused.comp");
+        m_ShaderPrograms["SPHFluidForceFused"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]FluidForceFused.comp");
+      }
+
+      // Kernel Normalizations (once per dispatch instead of once per neighbour)
+      const float pi = 3.14159f;
+      const float h = cellSize;
+      const float poly6 = 315.0f / (64.0f * pi * std::pow(h, 9.0f));
+      const float spiky = -45.0f / (pi * std::pow(h, 6.0f));
+      const float viscosityLaplacian = 45.0f / (pi * std::pow(h, 6.0f));
+
+      // Packed Particles (position, velocity, material and pressures, written by the density pass)
+      ReserveShaderStorageBuffer("FluidParticle", numInstances * sizeof(FluidParticle));
+      Resources::BindShaderStorageToLocation(47, m_BufferObjects["FluidParticle"]);
+
+      // 1. Density, Pressure and Packing
+      Resources::UseProgram(m_ShaderPrograms["SPHFluidDensityFused"]);
+      Resources::SetUniformFloat(m_ShaderPrograms["SPHFluidDensityFused"], "globalBounds", globalBounds);
+      Resources::SetUniformFloat(m_ShaderPrograms["SPHFluidDensityFused"], "cellSize", cellSize);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["SPHFluidDensityFused"], "hashTableSize", hashTableSize);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["SPHFluidDensityFused"], "gridMode", m_GridMode);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["SPHFluidDensityFused"], "numInstances", numInstances);
+      Resources::SetUniformFloat(m_ShaderPrograms["SPHFluidDensityFused"], "poly6Coefficient", poly6);
+      glDispatchCompute(groups, 1, 1);
+      glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+      // 2. Forces (neighbours come from the packed particles only)
+      Resources::UseProgram(m_ShaderPrograms["SPHFluidForceFused"]);
+      Resources::SetUniformFloat(m_ShaderPrograms["SPHFluidForceFused"], "globalBounds", globalBounds);
+      Resources::SetUniformFloat(m_ShaderPrograms["SPHFluidForceFused"], "cellSize", cellSize);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["SPHFluidForceFused"], "hashTableSize", hashTableSize);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["SPHFluidForceFused"], "gridMode", m_GridMode);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["SPHFluidForceFused"], "numInstances", numInstances);
+      Resources::SetUniformFloat(m_ShaderPrograms["SPHFluidForceFused"], "spikyCoefficient", spiky);
+      Resources::SetUniformFloat(m_ShaderPrograms["SPHFluidForceFused"], "viscosityCoefficient", viscosityLaplacian);
+      glDispatchCompute(groups, 1, 1);
+      glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+      m_GridScatterPending = (m_GridBuildOrder == SubmissionOrder);
+      return;
+    }
+
     // Compute Density (SPH)
     Resources::UseProgram(m_ShaderPrograms["SPHFluidDensity"]);
     Resources::SetUniformFloat(m_ShaderPrograms["SPHFluidDensity"], "globalBounds", globalBounds);
     Resources::SetUniformFloat(m_ShaderPrograms["SPHFluidDensity"], "cellSize", cellSize);
     Resources::SetUniformUnsignedInt(m_ShaderPrograms["SPHFluidDensity"], "hashTableSize", hashTableSize); // Hash Table Size
+    Resources::SetUniformUnsignedInt(m_ShaderPrograms["SPHFluidDensity"], "gridMode", m_GridMode);
     Resources::SetUniformUnsignedInt(m_ShaderPrograms["SPHFluidDensity"], "numInstances", numInstances);
 
     glDispatchCompute(groups, 1, 1);
@@ -357,48 +1949,73 @@ namespace Spade {
     Resources::SetUniformFloat(m_ShaderPrograms["SPHFluidForce"], "globalBounds", globalBounds);
     Resources::SetUniformFloat(m_ShaderPrograms["SPHFluidForce"], "cellSize", cellSize);
     Resources::SetUniformUnsignedInt(m_ShaderPrograms["SPHFluidForce"], "hashTableSize", hashTableSize); // Hash Table Size
+    Resources::SetUniformUnsignedInt(m_ShaderPrograms["SPHFluidForce"], "gridMode", m_GridMode);
     Resources::SetUniformUnsignedInt(m_ShaderPrograms["SPHFluidForce"], "numInstances", numInstances);
 
     glDispatchCompute(groups, 1, 1);
     glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 
-    // Scatter (Write Back)
-    Resources::UseProgram(m_ShaderPrograms["GridScatter"]);
-    Resources::SetUniformUnsignedInt(m_ShaderPrograms["GridScatter"], "numInstances", numInstances);
-    glDispatchCompute(groups, 1, 1);
-    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    // Density/Acceleration stay in the sorted arrays until the next scatter (already in place in SpatialOrder)
+    m_GridScatterPending = (m_GridBuildOrder == SubmissionOrder);
   }
 
   void Engine::EnableBruteForceCollision(float globalBounds) {
-    if (m_InstanceTransforms.empty()) return;
+    if (m_InstanceCount == 0) return;
+
+    if (m_SimulationDevice == CPUDevice) {
+      if (m_EntityBounds.empty() || m_EntityFluidMaterials.empty()) {
+        throw EngineException("LoadCollisionBuffers and LoadFluidBuffers must be called before EnableBruteForceCollision");
+      }
+
+      GetCPUPhysics().EnableBruteForceCollision(m_InstanceTransforms, m_InstanceMotions, m_InstanceToEntityIndex,
+        m_EntityBounds, m_EntityFluidMaterials, globalBounds);
+      InvalidateGrid();
+      return;
+    }
 
     if (!m_ShaderPrograms.contains("BruteForceCollision")) {
       // Only CollisionResolve is needed for Brute Force
       m_ShaderPrograms["BruteForceCollision"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]BruteForceCollision.comp");
     }
 
-    size_t numInstances = m_InstanceTransforms.size();
+    ScatterGrid();
+    InvalidateGrid();
+
+    size_t numInstances = m_InstanceCount;
     GLuint groups = (numInstances + 63) / 64;
 
     // 4. Resolve Collisions (Direct Brute Force)
     Resources::UseProgram(m_ShaderPrograms["BruteForceCollision"]);
     Resources::SetUniformFloat(m_ShaderPrograms["BruteForceCollision"], "globalBounds", globalBounds);
+    Resources::SetUniformUnsignedInt(m_ShaderPrograms["BruteForceCollision"], "numInstances", numInstances);
 
     glDispatchCompute(groups, 1, 1);
     glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
   }
 
   void Engine::EnableGridCollision(float globalBounds, float cellSize) {
-    if (m_InstanceTransforms.empty()) return;
+    if (m_InstanceCount == 0) return;
+
+    if (m_SimulationDevice == CPUDevice) {
+      if (m_EntityBounds.empty() || m_EntityFluidMaterials.empty()) {
+        throw EngineException("LoadCollisionBuffers and LoadFluidBuffers must be called before EnableGridCollision");
+      }
+
+      BuildGrid(globalBounds, cellSize);
+      GetCPUPhysics().EnableGridCollision(m_InstanceTransforms, m_InstanceMotions, m_InstanceToEntityIndex,
+        m_EntityBounds, m_EntityFluidMaterials);
+      InvalidateGrid();
+      return;
+    }
 
     if (!m_ShaderPrograms.contains("GridCollision")) {
       m_ShaderPrograms["GridCollision"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]GridCollision.comp");
     }
 
     BuildGrid(globalBounds, cellSize);
-    const unsigned int hashTableSize = 1 << 21;
+    const unsigned int hashTableSize = m_GridTableSize;
 
-    size_t numInstances = m_InstanceTransforms.size();
+    size_t numInstances = m_InstanceCount;
     GLuint groups = (numInstances + 63) / 64;
 
     // Solve Collision (on Sorted Data)
@@ -406,21 +2023,193 @@ namespace Spade {
     Resources::SetUniformFloat(m_ShaderPrograms["GridCollision"], "globalBounds", globalBounds);
     Resources::SetUniformFloat(m_ShaderPrograms["GridCollision"], "cellSize", cellSize);
     Resources::SetUniformUnsignedInt(m_ShaderPrograms["GridCollision"], "hashTableSize", hashTableSize); // Hash Table Size
+    Resources::SetUniformUnsignedInt(m_ShaderPrograms["GridCollision"], "gridMode", m_GridMode);
     Resources::SetUniformUnsignedInt(m_ShaderPrograms["GridCollision"], "numInstances", numInstances);
     glDispatchCompute(groups, 1, 1);
     glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
-    
+
+    // Positions moved inside the sorted arrays: keep them for the next scatter, rebuild before the next grid pass
+    m_GridScatterPending = (m_GridBuildOrder == SubmissionOrder);
+    InvalidateGrid();
+  }
+
+  void Engine::EnableBVHCollision(float globalBounds) {
+    if (m_InstanceCount == 0) return;
+
+    if (m_SimulationDevice == CPUDevice) {
+      if (m_EntityBounds.empty() || m_EntityFluidMaterials.empty()) {
+        throw EngineException("LoadCollisionBuffers and LoadFluidBuffers must be called before EnableBVHCollision");
+      }
+
+      GetCPUPhysics().EnableBVHCollision(m_InstanceTransforms, m_InstanceMotions, m_InstanceToEntityIndex,
+        m_EntityBounds, m_EntityFluidMaterials, globalBounds);
+      InvalidateGrid();
+      return;
+    }
+
+    // 1. Initialize Shaders (the tree is the Barnes-Hut one)
+    if (!m_ShaderPrograms.contains("BarnesHutTree")) {
+      m_ShaderPrograms["MortonCodes"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]MortonCodes.comp");
+      m_ShaderPrograms["BarnesHutTree"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]BarnesHutTree.comp");
+      m_ShaderPrograms["BarnesHutMass"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]BarnesHutMass.comp");
+      m_ShaderPrograms["BarnesHutForce"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]BarnesHutForce.comp");
+    }
+    if (!m_ShaderPrograms.contains("BVHCollision")) {
+      m_ShaderPrograms["BVHLeaves"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]BVHLeaves.comp");
+      m_ShaderPrograms["BVHCollision"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]BVHCollision.comp");
+    }
+
+    ScatterGrid();
+    InvalidateGrid();
+
+    unsigned int numBodies = m_InstanceCount;
+    unsigned int numNodes = 2 * numBodies - 1;
+    GLuint groups = (numBodies + 63) / 64;
+
+    ReserveShaderStorageBuffer("MortonPair", numBodies * sizeof(GridPair));
+    ReserveShaderStorageBuffer("BarnesHutNode", numNodes * sizeof(BarnesHutNode));
+    ReserveShaderStorageBuffer("BarnesHutParent", numNodes * sizeof(unsigned int));
+    ReserveShaderStorageBuffer("BarnesHutVisit", numBodies * sizeof(unsigned int));
+    Resources::BindShaderStorageToLocation(25, m_BufferObjects["BarnesHutNode"]);
+    Resources::BindShaderStorageToLocation(26, m_BufferObjects["BarnesHutParent"]);
+    Resources::BindShaderStorageToLocation(27, m_BufferObjects["BarnesHutVisit"]);
+    Resources::BindShaderStorageToLocation(28, m_BufferObjects["MortonPair"]);
+
+    ReserveShaderStorageBuffer("BVHVelocity", numBodies * sizeof(glm::vec4));
+    Resources::BindShaderStorageToLocation(48, m_BufferObjects["BVHVelocity"]);
+
+    // 2. Morton Codes and Sort (the box only shapes the curve, instances outside it are still handled)
+    Resources::UseProgram(m_ShaderPrograms["MortonCodes"]);
+    Resources::SetUniformFloat(m_ShaderPrograms["MortonCodes"], "globalBounds", globalBounds);
+    Resources::SetUniformUnsignedInt(m_ShaderPrograms["MortonCodes"], "numInstances", numBodies);
+    glDispatchCompute(groups, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    RadixSortPairs("MortonPair", numBodies, 30);
+
+    // 3. Build Tree (Leaves + Internal Nodes, one thread each)
+    Resources::UseProgram(m_ShaderPrograms["BarnesHutTree"]);
+    Resources::SetUniformUnsignedInt(m_ShaderPrograms["BarnesHutTree"], "numBodies", numBodies);
+    glDispatchCompute(groups, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // 4. Leaf Boxes (position +- size / 2) and velocity snapshot, then boxes merged bottom-up into every internal node
+    Resources::UseProgram(m_ShaderPrograms["BVHLeaves"]);
+    Resources::SetUniformUnsignedInt(m_ShaderPrograms["BVHLeaves"], "numBodies", numBodies);
+    glDispatchCompute(groups, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    Resources::UseProgram(m_ShaderPrograms["BarnesHutMass"]);
+    Resources::SetUniformUnsignedInt(m_ShaderPrograms["BarnesHutMass"], "numBodies", numBodies);
+    glDispatchCompute(groups, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // 5. Overlapping leaves are the candidate pairs, resolved as they are found (Tree Walk in Morton Order)
+    Resources::UseProgram(m_ShaderPrograms["BVHCollision"]);
+    Resources::SetUniformFloat(m_ShaderPrograms["BVHCollision"], "globalBounds", globalBounds);
+    Resources::SetUniformUnsignedInt(m_ShaderPrograms["BVHCollision"], "numBodies", numBodies);
+    glDispatchCompute(groups, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+  }
+
+  void Engine::ScatterGrid() {
+    if (!m_GridScatterPending) return;
+
+    size_t numInstances = m_InstanceCount;
+    GLuint groups = (numInstances + 63) / 64;
+
     // Scatter (Write Back)
     Resources::UseProgram(m_ShaderPrograms["GridScatter"]);
     Resources::SetUniformUnsignedInt(m_ShaderPrograms["GridScatter"], "numInstances", numInstances);
     glDispatchCompute(groups, 1, 1);
     glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    m_GridScatterPending = false;
   }
 
   void Engine::EnableBruteForceNewtonianGravity(float gravityConstant) {
     return;
   }
 
+  void Engine::EnableBarnesHutGravity(float gravityConstant, float globalBounds, float theta, float softening) {
+    if (m_InstanceCount == 0) return;
+
+    if (m_SimulationDevice == CPUDevice) {
+      GetCPUPhysics().EnableBarnesHutGravity(m_InstanceTransforms, m_InstanceMotions, gravityConstant, globalBounds, theta, softening);
+      InvalidateGrid();
+      return;
+    }
+
+    // 1. Initialize Shaders
+    if (!m_ShaderPrograms.contains("BarnesHutTree")) {
+      m_ShaderPrograms["MortonCodes"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]MortonCodes.comp");
+      m_ShaderPrograms["BarnesHutTree"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]BarnesHutTree.comp");
+      m_ShaderPrograms["BarnesHutMass"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]BarnesHutMass.comp");
+      m_ShaderPrograms["BarnesHutForce"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]BarnesHutForce.comp");
+    }
+
+    ScatterGrid();
+    InvalidateGrid();
+
+    unsigned int numBodies = m_InstanceCount;
+    unsigned int numNodes = 2 * numBodies - 1;
+    GLuint groups = (numBodies + 63) / 64;
+
+    // Internal nodes [0, numBodies - 1), leaves [numBodies - 1, numNodes), the root is node 0
+    ReserveShaderStorageBuffer("MortonPair", numBodies * sizeof(GridPair));
+    ReserveShaderStorageBuffer("BarnesHutNode", numNodes * sizeof(BarnesHutNode));
+    ReserveShaderStorageBuffer("BarnesHutParent", numNodes * sizeof(unsigned int));
+    ReserveShaderStorageBuffer("BarnesHutVisit", numBodies * sizeof(unsigned int));
+    Resources::BindShaderStorageToLocation(25, m_BufferObjects["BarnesHutNode"]);
+    Resources::BindShaderStorageToLocation(26, m_BufferObjects["BarnesHutParent"]);
+    Resources::BindShaderStorageToLocation(27, m_BufferObjects["BarnesHutVisit"]);
+    Resources::BindShaderStorageToLocation(28, m_BufferObjects["MortonPair"]);
+
+    // 2. Morton Codes (10 bits per axis inside globalBounds)
+    Resources::UseProgram(m_ShaderPrograms["MortonCodes"]);
+    Resources::SetUniformFloat(m_ShaderPrograms["MortonCodes"], "globalBounds", globalBounds);
+    Resources::SetUniformUnsignedInt(m_ShaderPrograms["MortonCodes"], "numInstances", numBodies);
+    glDispatchCompute(groups, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // 3. Sort Bodies along the Z-Order Curve
+    RadixSortPairs("MortonPair", numBodies, 30);
+
+    // 4. Build Tree (Leaves + Internal Nodes, one thread each)
+    Resources::UseProgram(m_ShaderPrograms["BarnesHutTree"]);
+    Resources::SetUniformUnsignedInt(m_ShaderPrograms["BarnesHutTree"], "numBodies", numBodies);
+    glDispatchCompute(groups, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // 5. Mass, Center of Mass and Bounds (Bottom-Up, the second child to arrive merges)
+    Resources::UseProgram(m_ShaderPrograms["BarnesHutMass"]);
+    Resources::SetUniformUnsignedInt(m_ShaderPrograms["BarnesHutMass"], "numBodies", numBodies);
+    glDispatchCompute(groups, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // 6. Forces (Tree Walk in Morton Order)
+    Resources::UseProgram(m_ShaderPrograms["BarnesHutForce"]);
+    Resources::SetUniformFloat(m_ShaderPrograms["BarnesHutForce"], "gravityConstant", gravityConstant);
+    Resources::SetUniformFloat(m_ShaderPrograms["BarnesHutForce"], "theta", theta);
+    Resources::SetUniformFloat(m_ShaderPrograms["BarnesHutForce"], "softening", softening);
+    Resources::SetUniformUnsignedInt(m_ShaderPrograms["BarnesHutForce"], "numBodies", numBodies);
+    glDispatchCompute(groups, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+  }
+
+
+  void Engine::RenderImpostor() {
+    RenderColor();
+
+    if (!m_ShaderPrograms.contains("Impostor")) {
+      m_ShaderPrograms["Impostor"] = Resources::CreateRenderProgram(
+      "assets/shaders/Impostor.vert",
+      "assets/shaders/[FRAGMENT]Impostor.frag",
+      "");
+    }
+
+    m_DrawImpostors = true;
+  }
 
   void Engine::RenderWireframe() {
     RenderShader("Color", "assets/shaders/[FRAGMENT]Wireframe.frag", "assets/shaders/[GEOMETRY]Barycentric.geom");
@@ -443,27 +2232,76 @@ namespace Spade {
     }
 
     m_ActiveProgram = m_ShaderPrograms[name];
+    m_DrawImpostors = false;
   }
 
 
   void Engine::DrawScene(Universe &universe, glm::vec4 clearColor) {
+    if (!HasContext()) return;
+
+    ScatterGrid();
+
+    // The CPU device owns the caches, the render only needs positions (and velocities) and the alive flags the cull skips
+    if (m_SimulationDevice == CPUDevice) {
+      const size_t transformBytes = m_InstanceTransforms.size() * sizeof(Transform);
+      const size_t motionBytes = m_InstanceMotions.size() * sizeof(Motion);
+      const size_t aliveBytes = m_InstanceAlive.size() * sizeof(unsigned int);
+
+      unsigned char* upload = MapUploadRegion(transformBytes + motionBytes + aliveBytes);
+      std::memcpy(upload, m_InstanceTransforms.data(), transformBytes);
+      std::memcpy(upload + transformBytes, m_InstanceMotions.data(), motionBytes);
+      std::memcpy(upload + transformBytes + motionBytes, m_InstanceAlive.data(), aliveBytes);
+
+      SubmitUploadRegion({{"InstanceTransform", transformBytes}, {"InstanceMotion", motionBytes}, {"InstanceAlive", aliveBytes}});
+    }
+
     Resources::ClearRenderBuffer(clearColor);
 
-    auto& meshPool = universe.GetPool<MeshComponent>();
+    if (m_SceneMeshCount > 0) {
+      if (!m_ShaderPrograms.contains("FrustumCull")) {
+        m_ShaderPrograms["FrustumCull"] = Resources::CreateComputeProgram("assets/shaders/[SYSTEM]FrustumCull.comp");
+      }
+
+      const unsigned int numInstances = m_InstanceCount;
+      const bool drawImpostors = m_DrawImpostors && m_SceneSphereCount > 0;
+      const unsigned int meshCommands = drawImpostors ? m_SceneMeshCount - m_SceneSphereCount : m_SceneMeshCount;
 
-    for(auto& meshComponent : meshPool.m_Data) {
-      Resources::UseProgram(m_ActiveProgram);
-      Resources::SetUniformUnsignedInt(m_ActiveProgram, "instanceStartIndex", meshComponent.instanceStartIndex);
+      // 1. Reset Commands (zero instances, baseInstance at each mesh's first slot, spheres on the quad for impostors)
+      Resources::CopyBufferObject(m_BufferObjects[drawImpostors ? "ImpostorCommandReset" : "DrawCommandReset"], m_BufferObjects["DrawCommand"], m_SceneMeshCount * sizeof(DrawElementsIndirectCommand));
+
+      // 2. Cull (compacts visible slots per mesh and counts them into the commands)
+      Resources::UseProgram(m_ShaderPrograms["FrustumCull"]);
+      Resources::SetUniformUnsignedInt(m_ShaderPrograms["FrustumCull"], "numInstances", numInstances);
+      glDispatchCompute((numInstances + 63) / 64, 1, 1);
+      glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+
+      // 3. Draw every mesh in one submission (sphere impostors in a second one)
+      Resources::BindVertexArrayObject(m_SceneVAO);
+      glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_BufferObjects["DrawCommand"]);
+
+      if (meshCommands > 0) {
+        Resources::UseProgram(m_ActiveProgram);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, meshCommands, 0);
+      }
 
-      Resources::BindVertexArrayObject(meshComponent.VAO);
-      glDrawElementsInstanced(GL_TRIANGLES, meshComponent.mesh.indices.size(), GL_UNSIGNED_INT, 0, meshComponent.instanceTransforms.size());
+      if (drawImpostors) {
+        Resources::UseProgram(m_ShaderPrograms["Impostor"]);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)(meshCommands * sizeof(DrawElementsIndirectCommand)), m_SceneSphereCount, 0);
+      }
 
+      glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
       Resources::UnbindVertexArrayObject();
     }
 
-    glfwSwapBuffers(m_GLFWwindow);
+    // Headless: nothing to present, just make sure the frame is submitted
+    if (m_Headless) {
+      glFlush();
+    } else {
+      glfwSwapBuffers(m_GLFWwindow);
+    }
     glfwPollEvents();
 
+    EndUploadFrame();
     UpdateStatistics();
 
   }
@@ -485,49 +2323,40 @@ namespace Spade {
       return;
     }
 
-    auto& inputPool = universe.GetPool<InputComponent>();
-    auto& transformPool = universe.GetPool<TransformComponent>();
-
-
-    for (size_t i = 0; i < inputPool.m_Data.size(); ++i) {
-      InputComponent& inputComponent = inputPool.m_Data[i];
-      const EntityID entityID = inputPool.m_IndexToEntity[i];
-
-      TransformComponent* transformComponent = transformPool.Get(entityID);
-
+    universe.View<InputComponent, TransformComponent>().Each([&](EntityID, InputComponent& inputComponent, TransformComponent& transformComponent) {
       for (auto& [key, input] : inputComponent.bindings) {
         if (IsKeyPressed(key)) {
           switch (input) {
 
             case MoveUp:
-              transformComponent->transform.position += inputComponent.speed * m_DeltaTime * transformComponent->GetUp();
+              transformComponent.transform.position += inputComponent.speed * m_DeltaTime * transformComponent.GetUp();
               break;
 
             case MoveDown:
-              transformComponent->transform.position -= inputComponent.speed * m_DeltaTime * transformComponent->GetUp();
+              transformComponent.transform.position -= inputComponent.speed * m_DeltaTime * transformComponent.GetUp();
               break;
 
             case MoveBackward:
-              transformComponent->transform.position -= inputComponent.speed * m_DeltaTime * transformComponent->GetForward();
+              transformComponent.transform.position -= inputComponent.speed * m_DeltaTime * transformComponent.GetForward();
               break;
 
             case MoveForward:
-              transformComponent->transform.position += inputComponent.speed * m_DeltaTime * transformComponent->GetForward();
+              transformComponent.transform.position += inputComponent.speed * m_DeltaTime * transformComponent.GetForward();
               break;
 
             case MoveLeft:
-              transformComponent->transform.position -= inputComponent.speed * m_DeltaTime * glm::normalize(glm::cross(transformComponent->GetForward(), transformComponent->GetUp()));
+              transformComponent.transform.position -= inputComponent.speed * m_DeltaTime * glm::normalize(glm::cross(transformComponent.GetForward(), transformComponent.GetUp()));
               break;
 
             case MoveRight:
-              transformComponent->transform.position += inputComponent.speed * m_DeltaTime * glm::normalize(glm::cross(transformComponent->GetForward(), transformComponent->GetUp()));
+              transformComponent.transform.position += inputComponent.speed * m_DeltaTime * glm::normalize(glm::cross(transformComponent.GetForward(), transformComponent.GetUp()));
               break;
 
           }
           LoadCameraBuffers(universe);
         }
       }
-    }
+    });
   }
 
 
@@ -536,6 +2365,65 @@ namespace Spade {
     SetupGLFWandGLADWindow(width, height, title);
   }
 
+  void Engine::SetupEngineHeadless(int width, int height) {
+    // Hidden null-platform window that only carries the context
+    SetupGLFWandGLADWindow(width, height, "Spade Headless", true);
+  }
+
+  void Engine::SetSimulationDevice(SimulationDevice simulationDevice) {
+    if (simulationDevice == m_SimulationDevice) return;
+
+    if (HasContext() && m_InstanceCount > 0) {
+      // To the CPU: the caches become the live data (buffers are reset to submission order for the render)
+      if (simulationDevice == CPUDevice) DownloadInstanceBuffers();
+
+      UploadInstanceBuffers();
+    }
+
+    m_SimulationDevice = simulationDevice;
+    InvalidateGrid();
+  }
+
+  void Engine::SetCPUThreadCount(unsigned int threadCount) {
+    // Recreated with the new pool on next use
+    m_CPUThreadCount = threadCount;
+    m_CPUPhysics.reset();
+    InvalidateGrid();
+  }
+
+  void Engine::SetCPUUseAVX2(bool useAVX2) {
+    m_CPUUseAVX2 = useAVX2;
+    if (m_CPUPhysics) m_CPUPhysics->SetUseAVX2(useAVX2);
+  }
+
+  CPUPhysics& Engine::GetCPUPhysics() {
+    if (!m_CPUPhysics) {
+      m_CPUPhysics = std::make_unique<CPUPhysics>(m_CPUThreadCount);
+      m_CPUPhysics->SetUseAVX2(m_CPUUseAVX2);
+    }
+
+    return *m_CPUPhysics;
+  }
+
+  std::vector<Motion> Engine::GetInstanceMotions() {
+    if (m_SimulationDevice == CPUDevice || !HasContext()) return m_InstanceMotions;
+
+    ScatterGrid();
+
+    std::vector<Motion> slotMotions(m_InstanceCount);
+    std::vector<unsigned int> instanceSlots(m_InstanceCount);
+    Resources::DownloadShaderStorageBufferObject<Motion>(slotMotions, m_BufferObjects["InstanceMotion"]);
+    Resources::DownloadShaderStorageBufferObject<unsigned int>(instanceSlots, m_BufferObjects["InstanceSlot"]);
+
+    // Back to submission order (emitted instances follow the loaded ones)
+    std::vector<Motion> motions(m_InstanceCount);
+    for (size_t i = 0; i < motions.size(); ++i) {
+      motions[i] = slotMotions[instanceSlots[i]];
+    }
+
+    return motions;
+  }
+
   float Engine::GetTime() const {
       return (float)glfwGetTime();
   }
@@ -558,13 +2446,25 @@ namespace Spade {
       }
   }
 
-  void Engine::SetupGLFWandGLADWindow(const int& width, const int& height, const std::string& title) {
+  void Engine::SetupGLFWandGLADWindow(const int& width, const int& height, const std::string& title, bool headless) {
+
+    // No display connection: the null platform only supports offscreen (EGL) contexts
+    if (headless) glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+
+    if (!glfwInit())
+    {
+      throw EngineException("Failed to initialize GLFW");
+    }
 
-    glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
+    if (headless) {
+      glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+      glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    }
+
     // Creates the GLFW Window with a Width, Height, Title, etc
     m_GLFWwindow = glfwCreateWindow(width, height, title.c_str(), nullptr, nullptr);
 
@@ -588,6 +2488,9 @@ namespace Spade {
     glViewport(0, 0, width, height);
 
     m_WindowSize = { (float)width, (float)height };
+    m_Headless = headless;
+
+    if (m_Headless) CreateOffscreenFramebuffer(width, height);
 
     glEnable(GL_DEPTH_TEST);
 
@@ -595,7 +2498,39 @@ namespace Spade {
     glTexStorage2D = (MY_PFNGLTEXSTORAGE2DPROC)glfwGetProcAddress("glTexStorage2D");
     glBindImageTexture = (MY_PFNGLBINDIMAGETEXTUREPROC)glfwGetProcAddress("glBindImageTexture");
     glDispatchCompute = (MY_PFNGLDISPATCHCOMPUTEPROC)glfwGetProcAddress("glDispatchCompute");
+    glDispatchComputeIndirect = (MY_PFNGLDISPATCHCOMPUTEINDIRECTPROC)glfwGetProcAddress("glDispatchComputeIndirect");
     glMemoryBarrier = (MY_PFNGLMEMORYBARRIERPROC)glfwGetProcAddress("glMemoryBarrier");
+    glMultiDrawElementsIndirect = (MY_PFNGLMULTIDRAWELEMENTSINDIRECTPROC)glfwGetProcAddress("glMultiDrawElementsIndirect");
+
+    // Persistent mapping is core in 4.4 (older contexts map the upload ring per upload instead)
+    GLint majorVersion = 0, minorVersion = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+    glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+    if (majorVersion > 4 || (majorVersion == 4 && minorVersion >= 4)) {
+      glBufferStorage = (MY_PFNGLBUFFERSTORAGEPROC)glfwGetProcAddress("glBufferStorage");
+    }
+  }
+
+  void Engine::CreateOffscreenFramebuffer(int width, int height) {
+    glGenFramebuffers(1, &m_OffscreenFramebuffer);
+    glGenRenderbuffers(1, &m_OffscreenColor);
+    glGenRenderbuffers(1, &m_OffscreenDepth);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, m_OffscreenColor);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_OffscreenDepth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    // Stays bound: every draw and clear lands here instead of the (missing) window surface
+    glBindFramebuffer(GL_FRAMEBUFFER, m_OffscreenFramebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_OffscreenColor);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_OffscreenDepth);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+      throw EngineException("Failed to create offscreen framebuffer");
+    }
   }
 
   void Engine::UpdateStatistics() {
@@ -610,6 +2545,9 @@ namespace Spade {
 
     m_FPSTimer += m_DeltaTime;
     m_FrameCounter++;
+
+    m_FrameUploadedBytes = m_UploadedBytes;
+    m_UploadedBytes = 0;
     m_TotalFrames++;
 
     if (m_FPSTimer >= 1.0f) {
@@ -619,10 +2557,19 @@ namespace Spade {
       m_FPSTimer = 0.0f;
     }
 
+#if defined(_WIN32)
     PROCESS_MEMORY_COUNTERS_EX pmc;
     if (GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&pmc, sizeof(pmc))) {
       m_Memory = pmc.PrivateUsage / 1024.0f / 1024.0f;
     }
+#elif defined(__linux__)
+    // Private resident memory: resident minus shared pages (/proc/self/statm counts pages)
+    std::ifstream statm("/proc/self/statm");
+    size_t totalPages = 0, residentPages = 0, sharedPages = 0;
+    if (statm >> totalPages >> residentPages >> sharedPages) {
+      m_Memory = (float)(residentPages - sharedPages) * (float)sysconf(_SC_PAGESIZE) / 1024.0f / 1024.0f;
+    }
+#endif
   }
 
   Engine::EngineException::EngineException(const std::string &message) : runtime_error(message) {}
@@ -1,8 +1,98 @@
 #include "Spade/Core/Objects.hpp"
+#include "Spade/Core/Archetype.hpp"
+
+#include <stdexcept>
 
 namespace Spade::Internal {
     ComponentTypeID GetUniqueComponentID() {
         static std::atomic<ComponentTypeID> lastID{0};
         return lastID++;
     }
+
+    ComponentTypeID GetUniqueViewID() {
+        static std::atomic<ComponentTypeID> lastID{0};
+        return lastID++;
+    }
+
+    static std::atomic<ChangeVersion> changeClock{0};
+
+    ChangeVersion NextChangeVersion() {
+        return ++changeClock;
+    }
+
+    ChangeVersion GetChangeVersion() {
+        return changeClock.load();
+    }
+}
+
+namespace Spade {
+    Universe::Universe() = default;
+    Universe::~Universe() = default;
+
+    ArchetypeStorage& Universe::GetArchetypes() {
+        if (!m_Archetypes) {
+            m_Archetypes = std::make_unique<ArchetypeStorage>();
+        }
+        return *m_Archetypes;
+    }
+
+    EntityID Universe::CreateEntityID() {
+        if (!m_FreeIndices.empty()) {
+            const EntityID index = m_FreeIndices.back();
+            m_FreeIndices.pop_back();
+            return m_Entities[index];
+        }
+
+        if (m_Entities.size() >= MAX_ENTITIES) {
+            throw std::length_error("Universe::CreateEntityID: out of entity indices");
+        }
+
+        const EntityID entity = MakeEntityID(static_cast<EntityID>(m_Entities.size()), 0);
+        m_Entities.push_back(entity);
+        return entity;
+    }
+
+    std::vector<EntityID> Universe::CreateEntityIDs(size_t count) {
+        std::vector<EntityID> entities;
+        entities.reserve(count);
+        m_Entities.reserve(m_Entities.size() + (count > m_FreeIndices.size() ? count - m_FreeIndices.size() : 0));
+
+        for (size_t i = 0; i < count; ++i) {
+            entities.push_back(CreateEntityID());
+        }
+        return entities;
+    }
+
+    void Universe::DestroyEntity(EntityID entity) {
+        DestroyEntities({ entity });
+    }
+
+    void Universe::DestroyEntities(const std::vector<EntityID>& entities) {
+        // 1. Retire Handles (the next generation waits in the free list, a repeated handle is no longer alive)
+        std::vector<EntityID> destroyed;
+        destroyed.reserve(entities.size());
+
+        for (EntityID entity : entities) {
+            if (!IsAlive(entity)) continue;
+
+            const EntityID index = GetEntityIndex(entity);
+            m_Entities[index] = MakeEntityID(index, GetEntityGeneration(entity) + 1);
+            m_FreeIndices.push_back(index);
+            destroyed.push_back(entity);
+        }
+
+        // 2. Pools (one pool at a time, with the old handles)
+        for (auto& pool : m_Pools) {
+            if (!pool) continue;
+            for (EntityID entity : destroyed) {
+                pool->Remove(entity);
+            }
+        }
+
+        if (m_Archetypes) {
+            for (EntityID entity : destroyed) {
+                m_Archetypes->RemoveEntity(entity);
+            }
+        }
+    }
 }
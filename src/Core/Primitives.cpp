@@ -65,6 +65,8 @@ namespace Spade {
         }
     }
 
+    mesh.sphereRadius = radius;
+
     return mesh;
   }
 
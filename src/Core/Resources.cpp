@@ -28,6 +28,11 @@ namespace Spade {
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
   }
 
+  void Resources::AllocateShaderStorageBufferObject(size_t size, const BufferID& SSBO) {
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, SSBO);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+  }
+
   void Resources::UpdateVertexBufferObject(const std::vector<Vertex>& vertices, const BufferID& VBO) {
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(Vertex), vertices.data());
@@ -38,6 +43,19 @@ namespace Spade {
     glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indices.size() * sizeof(unsigned int), indices.data());
   }
 
+  void Resources::CopyBufferObject(const BufferID& source, const BufferID& destination, size_t size, size_t readOffset, size_t writeOffset) {
+    glBindBuffer(GL_COPY_READ_BUFFER, source);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, destination);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, readOffset, writeOffset, size);
+  }
+
+  size_t Resources::GetBufferObjectSize(const BufferID& bufferID) {
+    GLint size = 0;
+    glBindBuffer(GL_COPY_READ_BUFFER, bufferID);
+    glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &size);
+    return size;
+  }
+
   std::string Resources::LoadShaderFile(const std::string& fileName) {
     std::ifstream shaderFile(fileName);
 
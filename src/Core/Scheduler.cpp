@@ -0,0 +1,141 @@
+#include "Spade/Core/Scheduler.hpp"
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <algorithm>
+#include <exception>
+
+namespace Spade {
+
+  Scheduler::Scheduler(unsigned int threadCount)
+    : m_ThreadPool(threadCount)
+  { }
+
+  Scheduler::System& Scheduler::AddSystem(const std::string& name, std::function<void()> run) {
+    m_Systems.push_back(std::make_unique<System>());
+    m_Systems.back()->m_Name = name;
+    m_Systems.back()->m_Run = std::move(run);
+    return *m_Systems.back();
+  }
+
+  Scheduler::System& Scheduler::AddSystem(const std::string& name, std::function<void(CommandBuffer&)> run) {
+    System& system = AddSystem(name, std::function<void()>());
+    system.m_Run = [&system, run = std::move(run)]() { run(system.m_Commands); };
+    return system;
+  }
+
+  Scheduler::System* Scheduler::GetSystem(const std::string& name) {
+    for (auto& system : m_Systems) {
+      if (system->m_Name == name) return system.get();
+    }
+    return nullptr;
+  }
+
+  bool Scheduler::Conflicts(const System& a, const System& b) {
+    auto intersects = [](const std::vector<ComponentTypeID>& x, const std::vector<ComponentTypeID>& y) {
+      for (ComponentTypeID id : x) {
+        if (std::find(y.begin(), y.end(), id) != y.end()) return true;
+      }
+      return false;
+    };
+
+    return intersects(a.m_Writes, b.m_Reads) || intersects(a.m_Writes, b.m_Writes) || intersects(a.m_Reads, b.m_Writes);
+  }
+
+  void Scheduler::Run() {
+    std::vector<System*> systems;
+    for (auto& system : m_Systems) {
+      if (system->m_Enabled) systems.push_back(system.get());
+    }
+    if (systems.empty()) return;
+
+    const size_t count = systems.size();
+
+    // 1. Dependency Graph (an earlier conflicting system first, context systems chained among themselves in order)
+    std::vector<std::vector<size_t>> dependents(count);
+    std::vector<std::atomic<size_t>> pending(count);
+    std::vector<size_t> depth(count, 1);
+    size_t lastContext = count;
+
+    for (size_t j = 0; j < count; ++j) {
+      size_t dependencies = 0;
+      for (size_t i = 0; i < j; ++i) {
+        if ((systems[j]->m_ContextThread && i == lastContext) || Conflicts(*systems[i], *systems[j])) {
+          dependents[i].push_back(j);
+          depth[j] = std::max(depth[j], depth[i] + 1);
+          ++dependencies;
+        }
+      }
+      pending[j].store(dependencies, std::memory_order_relaxed);
+      if (systems[j]->m_ContextThread) lastContext = j;
+    }
+    m_CriticalPathLength = *std::max_element(depth.begin(), depth.end());
+
+    // 2. Execution (pool systems are submitted as they become ready, context systems wait for this thread)
+    std::atomic<size_t> remaining = count;
+    std::mutex contextMutex;
+    std::deque<size_t> contextReady;
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+    std::function<void(size_t)> dispatch;
+
+    auto execute = [&](size_t s) {
+      try {
+        systems[s]->m_Run();
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!error) error = std::current_exception();
+      }
+
+      for (size_t d : dependents[s]) {
+        if (pending[d].fetch_sub(1, std::memory_order_acq_rel) == 1) dispatch(d);
+      }
+      remaining.fetch_sub(1, std::memory_order_release);
+    };
+
+    dispatch = [&](size_t s) {
+      if (systems[s]->m_ContextThread) {
+        std::lock_guard<std::mutex> lock(contextMutex);
+        contextReady.push_back(s);
+      } else {
+        m_ThreadPool.Submit([&execute, s]() { execute(s); });
+      }
+    };
+
+    for (size_t s = 0; s < count; ++s) {
+      if (pending[s].load(std::memory_order_relaxed) == 0) dispatch(s);
+    }
+
+    // 3. This thread runs the context systems and helps the pool in between
+    while (remaining.load(std::memory_order_acquire) > 0) {
+      size_t next = count;
+      {
+        std::lock_guard<std::mutex> lock(contextMutex);
+        if (!contextReady.empty()) {
+          next = contextReady.front();
+          contextReady.pop_front();
+        }
+      }
+
+      if (next != count) {
+        execute(next);
+      } else if (!m_ThreadPool.RunPendingTask()) {
+        std::this_thread::yield();
+      }
+    }
+
+    if (error) std::rethrow_exception(error);
+    m_ThreadPool.RethrowTaskError();
+  }
+
+  void Scheduler::Run(Universe& universe) {
+    Run();
+
+    for (auto& system : m_Systems) {
+      system->m_Commands.Apply(universe);
+    }
+  }
+
+}
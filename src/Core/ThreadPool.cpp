@@ -0,0 +1,173 @@
+#include "Spade/Core/ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace Spade {
+
+  // Pool and queue of the worker on this thread, any other thread (the caller) owns queue 0
+  static thread_local const ThreadPool* t_WorkerPool = nullptr;
+  static thread_local unsigned int t_WorkerIndex = 0;
+
+  ThreadPool::ThreadPool(unsigned int threadCount) {
+    // The caller of ParallelFor is one of the threads
+    threadCount = std::max(1u, threadCount);
+
+    for (unsigned int i = 0; i < threadCount; ++i) {
+      m_Queues.push_back(std::make_unique<WorkQueue>());
+    }
+
+    for (unsigned int i = 1; i < threadCount; ++i) {
+      m_Threads.emplace_back(&ThreadPool::WorkerLoop, this, i);
+    }
+  }
+
+  ThreadPool::~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(m_WakeMutex);
+      m_Stopping = true;
+    }
+    m_WakeCondition.notify_all();
+
+    for (auto& thread : m_Threads) {
+      thread.join();
+    }
+  }
+
+  void ThreadPool::ParallelFor(size_t begin, size_t end, size_t grainSize, const std::function<void(size_t, size_t)>& task) {
+    if (begin >= end) return;
+
+    grainSize = std::max<size_t>(1, grainSize);
+    size_t chunks = (end - begin + grainSize - 1) / grainSize;
+
+    // Not worth waking anyone
+    if (chunks == 1 || m_Threads.empty()) {
+      task(begin, end);
+      return;
+    }
+
+    std::atomic<size_t> remaining = chunks;
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+    // 1. Deal Chunks across the Queues (round robin, starting where the last call stopped)
+    unsigned int queue = m_NextQueue.fetch_add(1) % m_Queues.size();
+    for (size_t chunkBegin = begin; chunkBegin < end; chunkBegin += grainSize) {
+      size_t chunkEnd = std::min(end, chunkBegin + grainSize);
+
+      {
+        std::lock_guard<std::mutex> lock(m_Queues[queue]->mutex);
+        m_Queues[queue]->tasks.emplace_back([&task, &remaining, &errorMutex, &error, chunkBegin, chunkEnd]() {
+          try {
+            task(chunkBegin, chunkEnd);
+          } catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) error = std::current_exception();
+          }
+          remaining.fetch_sub(1, std::memory_order_release);
+        });
+      }
+      m_QueuedTasks.fetch_add(1, std::memory_order_release);
+
+      queue = (queue + 1) % m_Queues.size();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(m_WakeMutex);
+    }
+    m_WakeCondition.notify_all();
+
+    // 2. Help until every chunk of this call has finished (may run chunks of other calls too)
+    while (remaining.load(std::memory_order_acquire) > 0) {
+      if (!RunPendingTask()) {
+        std::this_thread::yield();
+      }
+    }
+
+    if (error) std::rethrow_exception(error);
+  }
+
+  void ThreadPool::Submit(std::function<void()> task) {
+    const unsigned int queue = m_NextQueue.fetch_add(1) % m_Queues.size();
+
+    {
+      std::lock_guard<std::mutex> lock(m_Queues[queue]->mutex);
+      m_Queues[queue]->tasks.emplace_back([this, task = std::move(task)]() {
+        try {
+          task();
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(m_ErrorMutex);
+          if (!m_TaskError) m_TaskError = std::current_exception();
+        }
+      });
+    }
+    m_QueuedTasks.fetch_add(1, std::memory_order_release);
+
+    {
+      std::lock_guard<std::mutex> lock(m_WakeMutex);
+    }
+    m_WakeCondition.notify_one();
+  }
+
+  bool ThreadPool::RunPendingTask() {
+    const unsigned int index = (t_WorkerPool == this) ? t_WorkerIndex : 0;
+
+    Task work;
+    if (!PopTask(index, work) && !StealTask(index, work)) return false;
+
+    work();
+    return true;
+  }
+
+  void ThreadPool::RethrowTaskError() {
+    std::exception_ptr error;
+    {
+      std::lock_guard<std::mutex> lock(m_ErrorMutex);
+      std::swap(error, m_TaskError);
+    }
+    if (error) std::rethrow_exception(error);
+  }
+
+  void ThreadPool::WorkerLoop(unsigned int index) {
+    t_WorkerPool = this;
+    t_WorkerIndex = index;
+
+    Task work;
+
+    while (true) {
+      if (PopTask(index, work) || StealTask(index, work)) {
+        work();
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(m_WakeMutex);
+      m_WakeCondition.wait(lock, [this]() { return m_Stopping || m_QueuedTasks.load(std::memory_order_acquire) > 0; });
+      if (m_Stopping) return;
+    }
+  }
+
+  bool ThreadPool::PopTask(unsigned int index, Task& task) {
+    WorkQueue& queue = *m_Queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    m_QueuedTasks.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  bool ThreadPool::StealTask(unsigned int thief, Task& task) {
+    for (size_t offset = 1; offset < m_Queues.size(); ++offset) {
+      WorkQueue& queue = *m_Queues[(thief + offset) % m_Queues.size()];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if (queue.tasks.empty()) continue;
+
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      m_QueuedTasks.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+    return false;
+  }
+
+}